@@ -0,0 +1,430 @@
+/* word search benchmarks - a separate program (not linked into word_search.exe), see README.txt:                      *
+ * word list build time, FindWord lookups (hit / prefix / miss) and OutputFoundWords over a fixed corpus of seeded     *
+ * random and adversarial grids, for every WordList backend, and ScoreBoards over a fixed corpus of random boards     *
+ * (checked against the plain search - see WordsGrid::SetFiltered); results are written as JSON to the standard output */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include "gen_defs.h"
+#include "word_list.h"
+#include "words_grid.h"
+#include "word_search.h"
+#include "thread_pool.h"
+
+using std::string;
+using std::vector;
+
+/* every measurement is repeated and the best (shortest) time is reported */
+const int REPEATS = 3;
+
+/* lookups per lookup kind */
+const size_t NO_OF_QUERIES = 200000;
+
+/* seed of the random queries and grids (the same corpus in every run) */
+const unsigned SEED = 12345;
+
+/* random 4x4 boards scored by ScoreBoards (own seed - the other grids are the same with or without them) */
+const size_t NO_OF_SCORED_BOARDS = 20000;
+
+/* lookup queries: words, prefixes of words (not words themselves) and strings that are neither */
+struct queries
+{
+	vector<string> hit;
+	vector<string> prefix;
+	vector<string> miss;
+};
+
+/* grids corpus: a named set of grids */
+struct grid_set
+{
+	const char *name;
+	vector<string> grids;
+};
+
+static double seconds_since (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* backends and board scores written so far (the JSON separator goes before every entry but the first) */
+static int no_of_backends = 0;
+static int no_of_scores = 0;
+
+/* text as a JSON string (quoted, '"', '\\' and control characters escaped) */
+static string json_string (const char *text)
+{
+	string json = "\"";
+	char escape[8];
+
+	for (; *text != '\0'; text++)
+	{
+		if ((*text == '"') || (*text == '\\'))
+		{
+			json += '\\';
+			json += *text;
+		}
+		else if ((unsigned char)*text < 0x20)
+		{
+			snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*text);
+			json += escape;
+		}
+		else
+		{
+			json += *text;
+		}
+	}
+
+	return json + "\"";
+}
+
+/* a-z words of a word list file (as BuildWorldList takes them) */
+static bool read_words (const char *file_name, vector<string>& words)
+{
+	std::ifstream file(file_name);
+	string word;
+
+	if (file.is_open() == false)
+	{
+		return false;
+	}
+
+	while (getline(file, word))
+	{
+		if ((word.empty() == false) && (word[word.length() - 1] == '\r'))
+		{
+			word.erase(word.length() - 1);
+		}
+		if ((word.empty() == false) && (std::all_of(word.begin(), word.end(), [](char ch) { return (ch >= 'a') && (ch <= 'z'); })))
+		{
+			words.push_back(word);
+		}
+	}
+
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+	return true;
+}
+
+/* make the lookup queries of every kind from the (sorted) words */
+static void make_queries (const vector<string>& words, queries& q)
+{
+	std::mt19937 random(SEED);
+	string query;
+
+	while (q.hit.size() < NO_OF_QUERIES)
+	{
+		q.hit.push_back(words[random() % words.size()]);
+	}
+
+	while (q.prefix.size() < NO_OF_QUERIES)
+	{
+		const string& word = words[random() % words.size()];
+		if (word.length() < 2)
+			continue;
+
+		query = word.substr(0, 1 + (random() % (word.length() - 1)));
+		if (std::binary_search(words.begin(), words.end(), query) == false)
+		{
+			q.prefix.push_back(query);
+		}
+	}
+
+	while (q.miss.size() < NO_OF_QUERIES)
+	{
+		/* a word with one character changed (misses deep in the word list) or a random string */
+		if (random() & 1)
+		{
+			query = words[random() % words.size()];
+			query[random() % query.length()] = (char)('a' + (random() % 26));
+		}
+		else
+		{
+			query.assign(3 + (random() % 8), 'a');
+			for (char& ch : query)
+			{
+				ch = (char)('a' + (random() % 26));
+			}
+		}
+
+		/* neither a word nor a prefix of a word: the first word not less than query doesn't start with it */
+		vector<string>::const_iterator next = std::lower_bound(words.begin(), words.end(), query);
+		if ((next == words.end()) || (next->compare(0, query.length(), query) != 0))
+		{
+			q.miss.push_back(query);
+		}
+	}
+}
+
+/* random grid of x_len x y_len, letters by their frequency in English text */
+static string random_grid (std::mt19937& random, int x_len, int y_len)
+{
+	static const char letters[] = "eeeeeeeeeeeettttttttaaaaaaaaoooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllccuuummwwffggyyppbbvkjxqz";
+	string grid;
+
+	for (int i = 0; i < x_len * y_len; i++)
+	{
+		grid.push_back(letters[random() % (sizeof(letters) - 1)]);
+	}
+
+	return grid;
+}
+
+/* random grid of the few letters that make the most paths (adversarial: the search goes deep from every cell) */
+static string dense_grid (std::mt19937& random, int x_len, int y_len)
+{
+	static const char letters[] = "aeinrst";
+	string grid;
+
+	for (int i = 0; i < x_len * y_len; i++)
+	{
+		grid.push_back(letters[random() % (sizeof(letters) - 1)]);
+	}
+
+	return grid;
+}
+
+static void make_grid_sets (vector<grid_set>& sets)
+{
+	std::mt19937 random(SEED);
+	int i;
+
+	sets.push_back(grid_set{ "readme_examples", { "abanzqzdrrorrnrr", "aahebcidbengmika", "abombanilenesess", "mikayuvaaahlmich" } });
+	sets.push_back(grid_set{ "random_4x4", {} });
+	for (i = 0; i < 2000; i++)
+		sets.back().grids.push_back(random_grid(random, 4, 4));
+	sets.push_back(grid_set{ "random_5x5", {} });
+	for (i = 0; i < 500; i++)
+		sets.back().grids.push_back(random_grid(random, 5, 5));
+	sets.push_back(grid_set{ "random_6x6", {} });
+	for (i = 0; i < 200; i++)
+		sets.back().grids.push_back(random_grid(random, 6, 6));
+	sets.push_back(grid_set{ "random_10x10", {} });
+	for (i = 0; i < 20; i++)
+		sets.back().grids.push_back(random_grid(random, 10, 10));
+	sets.push_back(grid_set{ "all_e", { string(16, 'e'), string(25, 'e'), string(36, 'e'), string(100, 'e') } });
+	sets.push_back(grid_set{ "dense_6x6", {} });
+	for (i = 0; i < 20; i++)
+		sets.back().grids.push_back(dense_grid(random, 6, 6));
+}
+
+/* FindWord over all queries of one kind: best time, and whether every result was the expected one */
+template <class WL>
+static void bench_lookup (const WL& word_list, const char *kind, const vector<string>& q, int expected, bool last)
+{
+	double best = 0;
+	size_t i, no_of_expected = 0;
+
+	for (int r = 0; r < REPEATS; r++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		no_of_expected = 0;
+		for (i = 0; i < q.size(); i++)
+		{
+			no_of_expected += (word_list.FindWord(q[i].c_str()) == expected);
+		}
+		double seconds = seconds_since(start);
+		best = ((r == 0) || (seconds < best)) ? seconds : best;
+	}
+
+	std::cout << "        \"" << kind << "\": { \"queries\": " << q.size() << ", \"seconds\": " << best
+	          << ", \"ns_per_query\": " << (best * 1e9 / q.size()) << ", \"correct\": " << ((no_of_expected == q.size()) ? "true" : "false") << " }" << (last ? "\n" : ",\n");
+}
+
+/* OutputFoundWords over every grid set */
+template <class WL>
+static void bench_solve (const WL& word_list, const vector<grid_set>& sets)
+{
+	WordsGridAnySize<WL> words_grid(word_list);
+	string found; /* found words of a grid (as the program's output) */
+	StringSink sink(found);
+	size_t s, i;
+
+	words_grid.SetOutputSink(&sink);
+
+	std::cout << "      \"solve\": [\n";
+	for (s = 0; s < sets.size(); s++)
+	{
+		double best = 0;
+		size_t no_of_words = 0;
+
+		for (int r = 0; r < REPEATS; r++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			no_of_words = 0;
+			for (i = 0; i < sets[s].grids.size(); i++)
+			{
+				found.clear();
+				words_grid.SetGrid(sets[s].grids[i].c_str());
+				words_grid.OutputFoundWords();
+				no_of_words += words_grid.GetNoFoundWords();
+			}
+			double seconds = seconds_since(start);
+			best = ((r == 0) || (seconds < best)) ? seconds : best;
+		}
+
+		std::cout << "        { \"grids\": \"" << sets[s].name << "\", \"no_of_grids\": " << sets[s].grids.size() << ", \"words_found\": " << no_of_words
+		          << ", \"seconds\": " << best << ", \"grids_per_sec\": " << ((best > 0) ? (sets[s].grids.size() / best) : 0) << " }"
+		          << ((s + 1 < sets.size()) ? ",\n" : "\n");
+	}
+	std::cout << "      ]\n";
+}
+
+/* ScoreBoards over the scored boards - on the calling thread and on a pool of one thread per core (best time of each); *
+ * plain - the same boards searched with the search filters off (see WordsGrid::SetFiltered) on one words grid, the    *
+ * reference of correct: every score is the number of words the plain search found and their total length            */
+template <class WL>
+static bool bench_score (const char *name, Dictionary::Backend backend, const char *word_list_file, const vector<string>& boards)
+{
+	Dictionary dictionary(backend);
+	WL word_list;
+	ThreadPool pool;
+	vector<BoardScore> scores;
+	double best[3] = { 0, 0, 0 };
+	bool correct = true;
+	return_code ret_code;
+	size_t i;
+
+	ret_code = dictionary.Load(word_list_file);
+	if ((ret_code != RC_NO_ERROR) || ((ret_code = word_list.BuildWorldList(word_list_file)) != RC_EOF))
+	{
+		std::cerr << name << ": can't load dictionary " << word_list_file << " (error code #" << ret_code << ")" << std::endl;
+		return false;
+	}
+
+	WordsGridAnySize<WL> plain(word_list);
+	vector<BoardScore> plain_scores(boards.size());
+	int total_length = 0;
+	auto add_length = [&total_length](const char *, size_t word_len) { total_length += (int)word_len; };
+	CallableSink<decltype(add_length)> sink(add_length);
+
+	plain.SetFiltered(false);
+	plain.SetOutputSink(&sink);
+	for (int r = 0; r < REPEATS; r++)
+	{
+		for (int threads = 0; threads < 2; threads++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			ScoreBoards(dictionary, boards, scores, (threads == 0) ? NULL : &pool);
+			double seconds = seconds_since(start);
+			best[threads] = ((r == 0) || (seconds < best[threads])) ? seconds : best[threads];
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (i = 0; i < boards.size(); i++)
+		{
+			total_length = 0;
+			plain.SetGrid(boards[i].c_str());
+			plain.OutputFoundWords();
+			plain_scores[i] = BoardScore{ plain.GetNoFoundWords(), total_length };
+		}
+		double seconds = seconds_since(start);
+		best[2] = ((r == 0) || (seconds < best[2])) ? seconds : best[2];
+	}
+
+	for (i = 0; (i < boards.size()) && correct; i++)
+	{
+		correct = (scores[i].no_of_words == plain_scores[i].no_of_words) && (scores[i].total_length == plain_scores[i].total_length);
+	}
+
+	std::cout << ((no_of_scores++ > 0) ? ",\n" : "") << "    { \"backend\": \"" << name << "\", \"boards\": " << boards.size() << ", \"seconds\": " << best[0]
+	          << ", \"boards_per_sec\": " << ((best[0] > 0) ? (boards.size() / best[0]) : 0) << ", \"threads\": " << pool.GetNoOfThreads()
+	          << ", \"threads_seconds\": " << best[1] << ", \"threads_boards_per_sec\": " << ((best[1] > 0) ? (boards.size() / best[1]) : 0)
+	          << ", \"plain_seconds\": " << best[2] << ", \"plain_boards_per_sec\": " << ((best[2] > 0) ? (boards.size() / best[2]) : 0)
+	          << ", \"correct\": " << (correct ? "true" : "false") << " }";
+
+	return true;
+}
+
+/* one backend's results: build (best of REPEATS fresh word lists), lookups and solve */
+template <class WL>
+static bool bench_backend (const char *name, const char *word_list_file, const queries& q, const vector<grid_set>& sets)
+{
+	double best = 0;
+	return_code ret_code = RC_EOF;
+	WL *word_list = NULL;
+
+	for (int r = 0; (r < REPEATS) && (ret_code == RC_EOF); r++)
+	{
+		delete word_list;
+		word_list = new WL;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		ret_code = word_list->BuildWorldList(word_list_file);
+		double seconds = seconds_since(start);
+		best = ((r == 0) || (seconds < best)) ? seconds : best;
+	}
+
+	if (ret_code != RC_EOF)
+	{
+		std::cerr << name << ": can't build word list " << word_list_file << " (error code #" << ret_code << ")" << std::endl;
+		delete word_list;
+		return false;
+	}
+
+	std::cout << ((no_of_backends++ > 0) ? ",\n" : "") << "    {\n      \"backend\": \"" << name << "\",\n";
+	std::cout << "      \"build\": { \"seconds\": " << best << ", \"words\": " << word_list->GetNoOfWords() << ", \"nodes\": " << word_list->GetNoOfNodes()
+	          << ", \"mem_bytes\": " << word_list->GetMemUsage() << " },\n";
+	std::cout << "      \"lookup\": {\n";
+	bench_lookup(*word_list, "hit", q.hit, WL::WORD_FOUND, false);
+	bench_lookup(*word_list, "prefix", q.prefix, WL::PREFIX_FOUND, false);
+	bench_lookup(*word_list, "miss", q.miss, WL::NOT_FOUND, true);
+	std::cout << "      },\n";
+	bench_solve(*word_list, sets);
+	std::cout << "    }";
+
+	delete word_list;
+	return true;
+}
+
+int main (int argc, char* argv[])
+{
+	vector<string> words;
+	vector<grid_set> sets;
+	vector<string> boards;
+	std::mt19937 random(SEED + 1);
+	queries q;
+	bool ok = true;
+
+	if (argc != 2)
+	{
+		std::cout << "Usage: word_search_bench.exe <word-list-file> (results as JSON to the standard output)\n";
+		return 1;
+	}
+
+	if ((read_words(argv[1], words) == false) || words.empty())
+	{
+		std::cerr << "Can't read words from: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	make_queries(words, q);
+	make_grid_sets(sets);
+	while (boards.size() < NO_OF_SCORED_BOARDS)
+	{
+		boards.push_back(random_grid(random, 4, 4));
+	}
+
+	std::cout.precision(6);
+	std::cout << "{\n  \"word_list\": " << json_string(argv[1]) << ",\n  \"words\": " << words.size() << ",\n  \"seed\": " << SEED << ",\n  \"backends\": [\n";
+	ok &= bench_backend<WordListTree::WordList>("WordListTree", argv[1], q, sets);
+	ok &= bench_backend<WordListSet::WordList>("WordListSet", argv[1], q, sets);
+	ok &= bench_backend<WordListArray::WordList>("WordListArray", argv[1], q, sets);
+	ok &= bench_backend<WordListDawg::WordList>("WordListDawg", argv[1], q, sets);
+	std::cout << "\n  ],\n  \"score\": [\n";
+	ok &= bench_score<WordListTree::WordList>("WordListTree", Dictionary::BACKEND_TREE, argv[1], boards);
+	ok &= bench_score<WordListSet::WordList>("WordListSet", Dictionary::BACKEND_SET, argv[1], boards);
+	ok &= bench_score<WordListArray::WordList>("WordListArray", Dictionary::BACKEND_ARRAY, argv[1], boards);
+	ok &= bench_score<WordListDawg::WordList>("WordListDawg", Dictionary::BACKEND_DAWG, argv[1], boards);
+	std::cout << "\n  ]\n}\n";
+
+	return ok ? 0 : 1;
+}
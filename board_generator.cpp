@@ -0,0 +1,559 @@
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gen_defs.h"
+#include "word_list.h"
+#include "words_grid.h"
+#include "word_search.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include "board_generator.h"
+
+// explicit instantiation (for every WordList backend)
+#define INSTANTIATE_BOARD_GENERATOR(WL) \
+	template class BoardSearch<WL>; \
+	template void GenerateBoards<WL>(const WL& word_list, const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool);
+
+INSTANTIATE_BOARD_GENERATOR(WordListTree::WordList)
+INSTANTIATE_BOARD_GENERATOR(WordListSet::WordList)
+INSTANTIATE_BOARD_GENERATOR(WordListArray::WordList)
+INSTANTIATE_BOARD_GENERATOR(WordListDawg::WordList)
+
+/* letters placed on generated boards, by their frequency in English text */
+static const char board_letters[] = "eeeeeeeeeeeettttttttaaaaaaaaoooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllccuuummwwffggyyppbbvkjxqz";
+
+/* largest board: a cell set is one 64 bit mask */
+const int MAX_BOARD_CELLS = GenerateOptions::MAX_CELLS;
+
+/* simulated annealing: the temperature starts at this part of a typical value change of a move and goes down to 0    *
+ * (the typical change - the mean of about the last DELTA_WINDOW moves that changed the value - fits every objective) */
+const double START_TEMPERATURE = 0.5;
+const int DELTA_WINDOW = 1000;
+
+/*******************************************************************************************************************************************************/
+/************************************************************ internal functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BoardSearch::set_cell_char                                                                                *
+*                                                                                                                     *
+* DESCRIPTION: set the character of a cell (and the board's letters) - the found words are not changed                *
+*                                                                                                                     *
+* PARAMETERS: cell (in) - cell index                                                                                  *
+*             ch (in) - character                                                                                     *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+void BoardSearch<WL>::set_cell_char(int cell, char ch)
+{
+	if (letter_bit(cells[cell]) != 0)
+	{
+		if (--letter_counts[cells[cell] - 'a'] == 0)
+			grid_letters &= ~letter_bit(cells[cell]);
+	}
+
+	cells[cell] = ch;
+	if (letter_bit(ch) != 0)
+	{
+		letter_counts[ch - 'a']++;
+		grid_letters |= letter_bit(ch);
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BoardSearch::search_start                                                                                 *
+*                                                                                                                     *
+* DESCRIPTION: search the found words of the board that start at one cell                                             *
+*                                                                                                                     *
+* PARAMETERS: start (in) - start cell                                                                                 *
+*             result (out) - its found words (each once), the cells read and the missing letters (see start_result)   *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: the same search as WordsGrid::output_found_words_from_prefix (iterative, RequiredLetters and NextChars       *
+*        prunes - only the adjacent cells of the prefix's next characters are tried) - the search looks at the        *
+*        characters around every prefix's last cell only to go on with the prefix's next characters (NextChars): the  *
+*        next characters of all the prefixes that end at a cell are what read_chars gets for the cells around it (any *
+*        character for the start cell)                                                                                *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+void BoardSearch<WL>::search_start(int start, start_result& result)
+{
+	search_frame *top = stack.data();
+	typename WL::Node node, next_node = WL::NO_NODE;
+	uint64_t used = (uint64_t)1 << start;
+	uint32_t slots;
+	int cell = start, word_len = 1, k, next_cell = 0;
+
+	result.words.clear();
+	result.read_chars.assign(grid.NoOfCells(), 0);
+	result.read_chars[start] = UINT32_MAX;
+	result.missing_letters = 0;
+	std::fill(next_chars.begin(), next_chars.end(), 0);
+
+	node = word_list.Step(word_list.Root(), cells[start]);
+	if (node == WL::NO_NODE)
+	{
+		return;
+	}
+
+	epoch++;
+	if (epoch == 0)
+	{
+		/* wrapped around - stamps of 2^32 searches ago would look current */
+		std::fill(word_epoch.begin(), word_epoch.end(), 0);
+		epoch = 1;
+	}
+
+	if (word_list.IsWord(node))
+	{
+		word_epoch[word_list.WordId(node)] = epoch;
+		result.words.push_back(found_word{ word_list.WordId(node), 1 });
+	}
+	next_chars[cell] |= word_list.NextChars(node);
+	slots = grid.NeighborSlots(cell, word_list.NextChars(node));
+
+	while (true)
+	{
+		for (; slots != 0; slots &= slots - 1)
+		{
+			next_cell = grid.Neighbor(cell, lowest_bit_index(slots));
+			if ((used & ((uint64_t)1 << next_cell)) != 0)
+			{
+				continue;
+			}
+
+			next_node = word_list.Step(node, cells[next_cell]);
+			if (next_node == WL::NO_NODE)
+			{
+				continue;
+			}
+
+			if ((word_list.RequiredLetters(next_node) & ~grid_letters) != 0)
+			{
+				result.missing_letters |= word_list.RequiredLetters(next_node) & ~grid_letters; /* another letter on the board may find more */
+				continue;
+			}
+
+			break;
+		}
+
+		if (slots == 0)
+		{
+			if (top == stack.data())
+			{
+				break;
+			}
+
+			used &= ~((uint64_t)1 << cell);
+			top--;
+			word_len--;
+			node = top->node;
+			cell = top->cell;
+			slots = top->slots;
+			continue;
+		}
+		slots &= slots - 1;
+
+		top->node = node;
+		top->cell = cell;
+		top->slots = slots;
+		top++;
+		word_len++;
+		used |= (uint64_t)1 << next_cell;
+		node = next_node;
+		cell = next_cell;
+		next_chars[cell] |= word_list.NextChars(node);
+		slots = grid.NeighborSlots(cell, word_list.NextChars(node));
+		if (word_list.IsWord(node) && (word_epoch[word_list.WordId(node)] != epoch))
+		{
+			word_epoch[word_list.WordId(node)] = epoch;
+			result.words.push_back(found_word{ word_list.WordId(node), (uint32_t)word_len });
+		}
+	}
+
+	for (cell = 0; cell < grid.NoOfCells(); cell++)
+	{
+		for (k = 0; k < grid.NeighborCount(cell); k++)
+			result.read_chars[grid.Neighbor(cell, k)] |= next_chars[cell];
+	}
+}
+
+/* count the found words of a start cell (a word found from many start cells is counted once) */
+template <class WL>
+void BoardSearch<WL>::add_start(const start_result& result)
+{
+	for (const found_word& word : result.words)
+	{
+		if (word_starts[word.word_id]++ == 0)
+		{
+			no_of_words++;
+			total_length += (int)word.length;
+		}
+	}
+}
+
+/* uncount the found words of a start cell */
+template <class WL>
+void BoardSearch<WL>::remove_start(const start_result& result)
+{
+	for (const found_word& word : result.words)
+	{
+		if (--word_starts[word.word_id] == 0)
+		{
+			no_of_words--;
+			total_length -= (int)word.length;
+		}
+	}
+}
+
+/* candidate board of a generator chain (see generate_chain) */
+struct board_candidate
+{
+	double value;
+	std::string key; /* canonical key (see ResultCache::CanonicalKey) - a board is kept once with its symmetries */
+	GeneratedBoard board;
+};
+
+/* board in ParseGrid form: a square board as one string, other boards as rows separated by '/' */
+static std::string board_string(const std::string& cells, int x_len, int y_len)
+{
+	std::string string;
+	int i;
+
+	if (x_len == y_len)
+	{
+		return cells;
+	}
+
+	for (i = 0; i < x_len; i++)
+	{
+		string.append(cells, i * y_len, y_len);
+		string.push_back('/');
+	}
+
+	return string;
+}
+
+/* value of a board for the objective (higher is better) */
+static double board_value(const GenerateOptions& options, int no_of_words, int total_length)
+{
+	switch (options.objective)
+	{
+	case GenerateOptions::MOST_WORDS: return no_of_words;
+	case GenerateOptions::LONGEST_WORDS: return total_length;
+	default: return -std::abs(no_of_words - options.target_words);
+	}
+}
+
+/* keep a board among the best (up to no_of_boards, best first) unless one of its symmetries is kept already */
+static void keep_board(std::vector<board_candidate>& best, size_t no_of_boards, board_candidate& candidate)
+{
+	std::vector<board_candidate>::iterator position;
+
+	for (const board_candidate& kept : best)
+	{
+		if (kept.key == candidate.key)
+			return;
+	}
+
+	position = std::upper_bound(best.begin(), best.end(), candidate, [](const board_candidate& a, const board_candidate& b) { return a.value > b.value; });
+	best.insert(position, std::move(candidate));
+	if (best.size() > no_of_boards)
+	{
+		best.pop_back();
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: generate_chain                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: simulated annealing from a random board until the deadline: change a random cell to a random letter,   *
+*              keep the change if the board is better, or worse by delta with probability exp(-delta / temperature)   *
+*                                                                                                                     *
+* PARAMETERS: word_list (in) - word list                                                                              *
+*             options (in) - board size, objective and number of boards                                               *
+*             seed (in) - random seed of the chain                                                                    *
+*             deadline (in) - time to stop                                                                            *
+*             best (out) - the best boards of the chain (up to options.no_of_boards, best first)                      *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: every change is searched incrementally (BoardSearch::SetCell), a rejected change is undone without a search  *
+*        the temperature is START_TEMPERATURE times the typical value change of a move and goes down linearly with    *
+*        the time left (hill climbing at the end)                                                                     *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+static void generate_chain(const WL& word_list, const GenerateOptions& options, unsigned seed, std::chrono::steady_clock::time_point deadline, std::vector<board_candidate>& best)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double budget = std::chrono::duration<double>(deadline - start).count();
+	BoardSearch<WL> board(word_list, options.x_len, options.y_len);
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> probability(0.0, 1.0);
+	std::string cells;
+	double value, next_value, delta, mean_delta = 0, temperature;
+	int cell, no_of_deltas = 0;
+	char ch;
+
+	for (cell = 0; cell < options.x_len * options.y_len; cell++)
+	{
+		cells.push_back(board_letters[random() % (sizeof(board_letters) - 1)]);
+	}
+	board.SetBoard(cells.c_str());
+	value = board_value(options, board.GetNoFoundWords(), board.GetTotalLength());
+
+	std::chrono::steady_clock::time_point now = start;
+	while (now < deadline)
+	{
+		if ((best.size() < options.no_of_boards) || (value > best.back().value))
+		{
+			board_candidate candidate;
+
+			candidate.value = value;
+			ResultCache::CanonicalKey(options.x_len, options.y_len, board.GetCells(), candidate.key);
+			candidate.board.grid = board_string(board.GetCells(), options.x_len, options.y_len);
+			candidate.board.score = BoardScore{ board.GetNoFoundWords(), board.GetTotalLength() };
+			keep_board(best, options.no_of_boards, candidate);
+		}
+
+		cell = (int)(random() % (unsigned)board.GetNoOfCells());
+		do
+		{
+			ch = board_letters[random() % (sizeof(board_letters) - 1)];
+		} while (ch == board.GetCells()[cell]);
+
+		board.SetCell(cell, ch);
+		next_value = board_value(options, board.GetNoFoundWords(), board.GetTotalLength());
+
+		delta = std::abs(next_value - value);
+		if (delta > 0)
+		{
+			no_of_deltas++;
+			mean_delta += (delta - mean_delta) / std::min(no_of_deltas, DELTA_WINDOW);
+		}
+
+		now = std::chrono::steady_clock::now();
+		temperature = START_TEMPERATURE * mean_delta * (budget > 0 ? std::chrono::duration<double>(deadline - now).count() / budget : 0);
+		if ((next_value >= value) || ((temperature > 0) && (probability(random) < std::exp((next_value - value) / temperature))))
+		{
+			value = next_value;
+		}
+		else
+		{
+			board.UndoSetCell();
+		}
+	}
+}
+
+/*******************************************************************************************************************************************************/
+/************************************************************ external functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+template <class WL>
+BoardSearch<WL>::BoardSearch(const WL& _word_list, int x_len, int y_len) : word_list(_word_list), grid(x_len, y_len)
+{
+	assert(grid.NoOfCells() <= MAX_BOARD_CELLS);
+
+	cells.assign(grid.NoOfCells(), '\0');
+	grid.SetCells(cells.c_str());
+
+	grid_letters = 0;
+	std::fill(letter_counts, letter_counts + 26, 0);
+	starts.resize(grid.NoOfCells());
+	undo_starts.resize(grid.NoOfCells());
+	for (start_result& result : starts)
+	{
+		result.read_chars.assign(grid.NoOfCells(), UINT32_MAX); /* not searched yet - any change searches it */
+	}
+	word_starts.assign(word_list.GetNoOfWordIds(), 0);
+	no_of_words = 0;
+	total_length = 0;
+	changed_cell = -1;
+	changed_from = '\0';
+	word_epoch.assign(word_list.GetNoOfWordIds(), 0);
+	epoch = 0;
+	stack.resize(grid.NoOfCells());
+	next_chars.assign(grid.NoOfCells(), 0);
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BoardSearch::SetBoard                                                                                     *
+*                                                                                                                     *
+* DESCRIPTION: set all the cells of the board and search it (from every start cell)                                   *
+*                                                                                                                     *
+* PARAMETERS: string - (in) the board's characters row by row (x_len x y_len, the size given to the constructor)      *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: a SetCell before cannot be undone after                                                                      *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+void BoardSearch<WL>::SetBoard(const char *string)
+{
+	int cell;
+
+	assert(strlen(string) == (size_t)grid.NoOfCells());
+
+	for (cell = 0; cell < grid.NoOfCells(); cell++)
+	{
+		remove_start(starts[cell]);
+		set_cell_char(cell, string[cell]);
+	}
+	grid.SetCells(cells.c_str());
+
+	for (cell = 0; cell < grid.NoOfCells(); cell++)
+	{
+		search_start(cell, starts[cell]);
+		add_start(starts[cell]);
+	}
+	changed_cell = -1;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BoardSearch::SetCell                                                                                      *
+*                                                                                                                     *
+* DESCRIPTION: change one cell of the board and update its found words                                                *
+*                                                                                                                     *
+* PARAMETERS: cell - (in) cell index                                                                                  *
+*             ch - (in) new character                                                                                 *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: only the start cells whose search read the cell are searched again, and those that skipped prefixes for the  *
+*        new letter (it was not on the board) - the other start cells find the same words as before                   *
+*        (a letter no longer on the board only left them a prefix they could not complete anyway)                     *
+*        the change can be undone (UndoSetCell) until the next SetCell or SetBoard                                    *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+void BoardSearch<WL>::SetCell(int cell, char ch)
+{
+	uint32_t chars = char_bit(cells[cell]) | char_bit(ch);
+	int start;
+
+	changed_cell = cell;
+	changed_from = cells[cell];
+	set_cell_char(cell, ch);
+	grid.SetCells(cells.c_str());
+
+	changed_starts.clear();
+	for (start = 0; start < grid.NoOfCells(); start++)
+	{
+		if (((starts[start].read_chars[cell] & chars) == 0) && ((starts[start].missing_letters & letter_bit(ch)) == 0))
+		{
+			continue;
+		}
+
+		changed_starts.push_back(start);
+		remove_start(starts[start]);
+		std::swap(starts[start], undo_starts[start]); /* the results before are kept for UndoSetCell */
+		search_start(start, starts[start]);
+		add_start(starts[start]);
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BoardSearch::UndoSetCell                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: undo the last SetCell - the cell and the found words are as before it (nothing is searched)            *
+*                                                                                                                     *
+* PARAMETERS: none                                                                                                    *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: must be called at most once after a SetCell                                                                  *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+void BoardSearch<WL>::UndoSetCell()
+{
+	assert(changed_cell >= 0);
+
+	for (int start : changed_starts)
+	{
+		remove_start(starts[start]);
+		std::swap(starts[start], undo_starts[start]);
+		add_start(starts[start]);
+	}
+	changed_starts.clear();
+
+	set_cell_char(changed_cell, changed_from);
+	grid.SetCells(cells.c_str());
+	changed_cell = -1;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: GenerateBoards                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: generate boards - the best boards found for the objective under a time budget                          *
+*                                                                                                                     *
+* PARAMETERS: word_list (in) - word list                                                                              *
+*             options (in) - see GenerateOptions                                                                      *
+*             boards (out) - the best boards (up to options.no_of_boards, best first)                                 *
+*             pool (in) - thread pool to generate on (NULL - on the calling thread)                                   *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: one simulated annealing chain (see generate_chain) per pool thread, each with its own seed; the chains' best *
+*        boards are merged (a board or a rotation or reflection of it is kept once)                                   *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+void GenerateBoards(const WL& word_list, const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool)
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.seconds));
+	int no_of_chains = (pool != NULL) ? pool->GetNoOfThreads() : 1, chain;
+	std::vector<std::vector<board_candidate> > chain_best(no_of_chains);
+	std::vector<board_candidate> best;
+
+	if (pool == NULL)
+	{
+		generate_chain(word_list, options, options.seed, deadline, chain_best[0]);
+	}
+	else
+	{
+		for (chain = 0; chain < no_of_chains; chain++)
+		{
+			pool->Submit([&word_list, &options, &chain_best, chain, deadline]()
+			{
+				generate_chain(word_list, options, options.seed + (unsigned)chain, deadline, chain_best[chain]);
+			});
+		}
+		pool->Wait();
+	}
+
+	for (chain = 0; chain < no_of_chains; chain++)
+	{
+		for (board_candidate& candidate : chain_best[chain])
+		{
+			if ((best.size() < options.no_of_boards) || (candidate.value > best.back().value))
+				keep_board(best, options.no_of_boards, candidate);
+		}
+	}
+
+	boards.clear();
+	for (board_candidate& candidate : best)
+	{
+		boards.push_back(std::move(candidate.board));
+	}
+}
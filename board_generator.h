@@ -0,0 +1,100 @@
+#ifndef _BOARD_GENERATOR_H_
+#define _BOARD_GENERATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gen_defs.h"
+#include "word_list.h"
+#include "words_grid.h"
+#include "word_search.h"
+
+/* found words of a board that changes one cell at a time (board generation) - WL: the word list class of any backend *
+ * the words are kept by the start cell they were found from, with the characters each start cell's search depends on *
+ * in every cell: a changed cell re-searches only the start cells that depend on its old or new character, not the    *
+ * whole board (boards of up to 64 cells)                                                                            */
+template <class WL>
+class BoardSearch
+{
+private:
+	/* a found word: word id (see WL::WordId) and length */
+	struct found_word
+	{
+		uint32_t word_id;
+		uint32_t length;
+	};
+
+	/* search from one start cell: its found words (each once), per cell the characters that would have changed the     *
+	 * search (see char_bit) and the letters it skipped prefixes for (see RequiredLetters) - not on the board then     */
+	struct start_result
+	{
+		std::vector<found_word> words;
+		std::vector<uint32_t> read_chars;
+		uint32_t missing_letters;
+	};
+
+	/* search stack frame (as in WordsGrid) */
+	struct search_frame
+	{
+		typename WL::Node node;
+		int cell;
+		uint32_t slots;
+	};
+
+	const WL& word_list;
+	GridLayout<GRID_ANY_SIZE, GRID_ANY_SIZE> grid;
+	std::string cells;
+
+	/* letters of the board (see letter_bit) and the number of cells of each letter */
+	uint32_t grid_letters;
+	int letter_counts[26];
+
+	/* per start cell: see start_result */
+	std::vector<start_result> starts;
+
+	/* per word id: number of start cells it was found from (a board's word is counted once) */
+	std::vector<uint16_t> word_starts;
+	int no_of_words;
+	int total_length;
+
+	/* the last SetCell (see UndoSetCell): the cell, its character before and the start cells it re-searched (their *
+	 * results before are kept in undo_starts)                                                                     */
+	int changed_cell;
+	char changed_from;
+	std::vector<int> changed_starts;
+	std::vector<start_result> undo_starts;
+
+	/* found words dedup within one start cell's search (as in WordsGrid) */
+	std::vector<uint32_t> word_epoch;
+	uint32_t epoch;
+
+	std::vector<search_frame> stack;
+
+	/* per cell: the next characters (see NextChars) of the prefixes that end at it, in one start cell's search */
+	std::vector<uint32_t> next_chars;
+
+	void set_cell_char(int cell, char ch);
+	void search_start(int start, start_result& result);
+	void add_start(const start_result& result);
+	void remove_start(const start_result& result);
+
+public:
+
+	BoardSearch(const WL& word_list, int x_len, int y_len);
+	BoardSearch(const BoardSearch&) = delete;
+	BoardSearch& operator=(const BoardSearch&) = delete;
+
+	void SetBoard(const char *string);
+	void SetCell(int cell, char ch);
+	void UndoSetCell();
+	const std::string& GetCells() const { return cells; }
+	int GetNoOfCells() const { return grid.NoOfCells(); }
+	int GetNoFoundWords() const { return no_of_words; }
+	int GetTotalLength() const { return total_length; }
+};
+
+/* generate boards with the word list of any backend (see GenerateBoards in word_search.h) */
+template <class WL>
+void GenerateBoards(const WL& word_list, const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool);
+
+#endif // _BOARD_GENERATOR_H_
@@ -0,0 +1,146 @@
+#include <iostream>
+
+#include "gen_defs.h"
+#include "file_map.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* an empty file can't be mapped - it is "mapped" to this instead */
+static const char empty_file[1] = { '\0' };
+
+FileMap::FileMap()
+{
+	data = NULL;
+	size = 0;
+
+#ifdef _WIN32
+	file_handle = INVALID_HANDLE_VALUE;
+	mapping_handle = NULL;
+#endif
+}
+
+FileMap::~FileMap()
+{
+	Close();
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Open                                                                                                      *
+*                                                                                                                     *
+* DESCRIPTION: map a whole file to memory (read only)                                                                 *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - file name                                                                              *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error (Data()/Size() give the file's content)                                           *
+*            RC_FILE_NOT_FOUND - file not found (or can't be mapped)                                                  *
+*                                                                                                                     *
+* NOTES: the mapping stays valid until Close() (or destruction)                                                       *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code FileMap::Open(const char *file_name)
+{
+	Close();
+
+#ifdef _WIN32
+	LARGE_INTEGER file_size;
+
+	file_handle = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if ((file_handle == INVALID_HANDLE_VALUE) || (GetFileSizeEx((HANDLE)file_handle, &file_size) == FALSE))
+	{
+		std::cerr << "Can't open file: " << file_name << std::endl;
+		Close();
+		return RC_FILE_NOT_FOUND;
+	}
+
+	size = (size_t)file_size.QuadPart;
+	if (size == 0)
+	{
+		data = empty_file;
+		return RC_NO_ERROR;
+	}
+
+	mapping_handle = CreateFileMappingA((HANDLE)file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping_handle != NULL)
+	{
+		data = (const char*)MapViewOfFile((HANDLE)mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	struct stat file_stat;
+	void *mapped;
+	int fd;
+
+	fd = open(file_name, O_RDONLY);
+	if ((fd < 0) || (fstat(fd, &file_stat) != 0))
+	{
+		std::cerr << "Can't open file: " << file_name << std::endl;
+		if (fd >= 0)
+			close(fd);
+		return RC_FILE_NOT_FOUND;
+	}
+
+	size = (size_t)file_stat.st_size;
+	if (size == 0)
+	{
+		close(fd);
+		data = empty_file;
+		return RC_NO_ERROR;
+	}
+
+	mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); /* the mapping keeps its own reference to the file */
+	if (mapped != MAP_FAILED)
+	{
+		data = (const char*)mapped;
+	}
+#endif
+
+	if (data == NULL)
+	{
+		std::cerr << "Can't map file: " << file_name << std::endl;
+		Close();
+		return RC_FILE_NOT_FOUND;
+	}
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Close                                                                                                     *
+*                                                                                                                     *
+* DESCRIPTION: unmap the file (if mapped)                                                                             *
+*                                                                                                                     *
+* PARAMETERS: none                                                                                                    *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void FileMap::Close()
+{
+#ifdef _WIN32
+	if ((data != NULL) && (data != empty_file))
+		UnmapViewOfFile(data);
+	if (mapping_handle != NULL)
+		CloseHandle((HANDLE)mapping_handle);
+	if (file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle((HANDLE)file_handle);
+	file_handle = INVALID_HANDLE_VALUE;
+	mapping_handle = NULL;
+#else
+	if ((data != NULL) && (data != empty_file))
+		munmap((void*)data, size);
+#endif
+
+	data = NULL;
+	size = 0;
+}
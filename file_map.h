@@ -0,0 +1,33 @@
+#ifndef _FILE_MAP_H_
+#define _FILE_MAP_H_
+
+#include <cstddef>
+#include "gen_defs.h"
+
+/* read-only memory mapping of a whole file */
+class FileMap
+{
+private:
+	const char *data;
+	size_t size;
+
+#ifdef _WIN32
+	void *file_handle;
+	void *mapping_handle;
+#endif
+
+public:
+
+	FileMap();
+	~FileMap();
+	FileMap(const FileMap&) = delete;
+	FileMap& operator=(const FileMap&) = delete;
+
+	return_code Open(const char *file_name);
+	void Close();
+	bool IsOpen() const { return data != NULL; }
+	const char *Data() const { return data; }
+	size_t Size() const { return size; }
+};
+
+#endif // _FILE_MAP_H_
@@ -8,6 +8,10 @@ enum return_code
    RC_NO_ERROR,
    RC_NO_MEM,
    RC_FILE_NOT_FOUND,
+   RC_FILE_WRITE_ERROR,
+   RC_BAD_IMAGE,
+   RC_INVALID_GRID,
+   RC_SOCKET_ERROR,
 
    /* internal */
    RC_EOF
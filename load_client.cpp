@@ -0,0 +1,161 @@
+/* solver server load generator - a separate program (not linked into word_search.exe), see README.txt:               *
+ * sends the grids of a grids file to a server (word_search.exe serve) over many connections, with many requests    *
+ * in flight per connection, and reports throughput and latency percentiles to the standard output                 */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "gen_defs.h"
+#include "server.h"
+
+using std::string;
+using std::vector;
+
+typedef std::chrono::steady_clock::time_point time_point;
+
+/* one connection's results */
+struct connection_result
+{
+	vector<double> latencies; /* seconds, one per answered request */
+	size_t no_of_errors;      /* responses that are not RC_NO_ERROR / RC_INVALID_GRID, or lost */
+	size_t no_of_words;
+};
+
+static uint32_t get_uint32 (const char *data)
+{
+	return (uint32_t)(unsigned char)data[0] | ((uint32_t)(unsigned char)data[1] << 8) | ((uint32_t)(unsigned char)data[2] << 16) | ((uint32_t)(unsigned char)data[3] << 24);
+}
+
+/* send grids[first], grids[first + step], ... on one connection, up to pipeline_depth requests in flight at a time */
+static void run_connection (const char *address, const vector<string>& grids, size_t first, size_t step, size_t pipeline_depth, connection_result& result)
+{
+	std::deque<time_point> sent; /* send time of every request in flight (responses come in request order) */
+	time_point send_time;
+	string response;
+	size_t next = first;
+	int connection;
+
+	result.no_of_errors = 0;
+	result.no_of_words = 0;
+
+	connection = ConnectServer(address);
+	if (connection < 0)
+	{
+		for (; next < grids.size(); next += step)
+			result.no_of_errors++;
+		return;
+	}
+
+	while ((next < grids.size()) || (sent.empty() == false))
+	{
+		while ((next < grids.size()) && (sent.size() < pipeline_depth))
+		{
+			send_time = std::chrono::steady_clock::now();
+			if (WriteFrame(connection, grids[next].data(), grids[next].size()) == false)
+				break;
+			sent.push_back(send_time);
+			next += step;
+		}
+
+		/* nothing in flight - a request could not be sent (it is counted below as not answered) */
+		if (sent.empty())
+			break;
+
+		if (ReadFrame(connection, response) == false)
+			break;
+
+		result.latencies.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - sent.front()).count());
+		sent.pop_front();
+
+		if ((response.size() < 8) || ((get_uint32(&response[0]) != RC_NO_ERROR) && (get_uint32(&response[0]) != RC_INVALID_GRID)))
+			result.no_of_errors++;
+		else
+			result.no_of_words += get_uint32(&response[4]);
+	}
+
+	/* requests not answered (connection lost) */
+	result.no_of_errors += sent.size();
+	for (; next < grids.size(); next += step)
+		result.no_of_errors++;
+
+	CloseConnection(connection);
+}
+
+static double percentile (const vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+
+	return sorted[std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5))];
+}
+
+int main (int argc, char* argv[])
+{
+	vector<string> grids;
+	string grid;
+	size_t no_of_connections = 1, pipeline_depth = 1, i;
+
+	if ((argc < 3) || (argc > 5))
+	{
+		std::cout << "Usage: word_search_load.exe <port or socket-path> <grids-file> [<connections> [<pipeline-depth>]] (defaults: 1 1)\n";
+		return 1;
+	}
+
+	std::ifstream file(argv[2]);
+	if (file.is_open() == false)
+	{
+		std::cerr << "Can't open file: " << argv[2] << std::endl;
+		return 1;
+	}
+	while (getline(file, grid))
+	{
+		if ((grid.empty() == false) && (grid[grid.length() - 1] == '\r'))
+			grid.erase(grid.length() - 1);
+		if (grid.empty() == false)
+			grids.push_back(grid);
+	}
+
+	if (argc >= 4)
+		no_of_connections = std::max(1, atoi(argv[3]));
+	if (argc >= 5)
+		pipeline_depth = std::max(1, atoi(argv[4]));
+
+	vector<connection_result> results(no_of_connections);
+	vector<std::thread> threads;
+
+	time_point start = std::chrono::steady_clock::now();
+	for (i = 0; i < no_of_connections; i++)
+	{
+		threads.emplace_back(run_connection, argv[1], std::cref(grids), i, no_of_connections, pipeline_depth, std::ref(results[i]));
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	vector<double> latencies;
+	size_t no_of_errors = 0, no_of_words = 0;
+	for (const connection_result& result : results)
+	{
+		latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+		no_of_errors += result.no_of_errors;
+		no_of_words += result.no_of_words;
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	std::cout << latencies.size() << " requests answered in " << seconds << " s (" << ((seconds > 0) ? (latencies.size() / seconds) : 0) << " requests/sec, "
+	          << no_of_connections << " connections, pipeline depth " << pipeline_depth << ")\n";
+	std::cout << "latency (us): p50 " << percentile(latencies, 0.50) * 1e6 << ", p99 " << percentile(latencies, 0.99) * 1e6
+	          << ", max " << (latencies.empty() ? 0 : latencies.back() * 1e6) << "\n";
+	std::cout << no_of_words << " words found, " << no_of_errors << " errors\n";
+
+	return (no_of_errors == 0) ? 0 : 1;
+}
@@ -1,69 +1,418 @@
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
 
 #include "gen_defs.h"
 #include "words_grid.h"
+#include "word_search.h"
+#include "server.h"
+#include "thread_pool.h"
+
+using std::string;
+using std::vector;
 
 //#define _MY_DEBUG_
 
-const int GRID_X_LEN = 4;
-const int GRID_Y_LEN = 4;
+/* names of the dictionary backends (-d <backend>; the default is dawg - the only one that can load a compiled image file) */
+static const char *backend_names[Dictionary::NO_OF_BACKENDS] = { "tree", "set", "array", "dawg" };
+
+static return_code compile_word_list (const char *word_list_file, const char *image_file);
+static void solve_chunk (const Dictionary& dictionary, ThreadPool& pool, vector<string>& grids, vector<string>& outputs, bool paths);
+static return_code solve_batch (const Dictionary& dictionary, const char *grids_file, int no_of_threads, bool paths);
+static return_code solve_grid (const Dictionary& dictionary, const char *grid, int no_of_threads, bool paths);
+static return_code check_words (const Dictionary& dictionary, const char *grid, int no_of_words, char *words[]);
+static return_code generate_boards (const Dictionary& dictionary, GenerateOptions& options, int no_of_threads);
+
+/* compile mode: build the dawg of a word list file once and save it as a binary image file (mapped by later runs) */
+static return_code compile_word_list (const char *word_list_file, const char *image_file)
+{
+	WordListDawg::WordList word_list;
+	return_code ret_code;
+
+	ret_code = word_list.BuildWorldList(word_list_file);
+	if (ret_code == RC_EOF)
+	{
+		ret_code = word_list.SaveImage(image_file);
+	}
+
+	return ret_code;
+}
+
+/* solve a chunk of grids on the pool (each grid into its own output buffer) and write the outputs in input order *
+ * an empty grid is an invalid input line - its output is already set; paths - each word is followed by its path */
+static void solve_chunk (const Dictionary& dictionary, ThreadPool& pool, vector<string>& grids, vector<string>& outputs, bool paths)
+{
+	/* grids solved by one task (fewer, larger tasks - each thread reuses its own words grid anyway, see Solve) */
+	const size_t GRIDS_PER_TASK = 64;
+
+	size_t i;
+
+	for (i = 0; i < grids.size(); i += GRIDS_PER_TASK)
+	{
+		pool.Submit([&dictionary, &grids, &outputs, i, GRIDS_PER_TASK, paths]()
+		{
+			int no_found_words;
+			size_t k;
+
+			for (k = i; (k < grids.size()) && (k < i + GRIDS_PER_TASK); k++)
+			{
+				if (grids[k].empty())
+					continue;
+
+				StringSink sink(outputs[k], paths);
+				Solve(dictionary, grids[k].c_str(), sink, &no_found_words);
 
+				outputs[k] += std::to_string(no_found_words) + " words found\n\n";
+			}
+		});
+	}
+	pool.Wait();
 
-static void words_grid_output_func (const char *word);
+	for (i = 0; i < outputs.size(); i++)
+	{
+		std::cout << outputs[i];
+	}
 
-static void words_grid_output_func (const char *word)
+	grids.clear();
+	outputs.clear();
+}
+
+/* batch mode: solve every grid (one per line) of a grids file (or of the standard input) with the same word list    *
+ * on a pool of threads; each grid's found words are followed by "<n> words found" and an empty line, in input order *
+ * throughput goes to standard error                                                                                 */
+static return_code solve_batch (const Dictionary& dictionary, const char *grids_file, int no_of_threads, bool paths)
 {
 	using std::cout;
+	using std::cerr;
 	using std::endl;
 
-	cout << word << endl;
+	/* grids read ahead and solved together (bounds the memory used for a long input) */
+	const size_t CHUNK_SIZE = 4096;
+
+	std::ifstream file;
+	std::istream *input = &std::cin;
+	vector<string> grids, outputs;
+	string grid;
+	int x_len, y_len;
+	size_t line_no = 0, no_of_grids = 0;
+
+	if ((grids_file != NULL) && (strcmp(grids_file, "-") != 0))
+	{
+		file.open(grids_file);
+		if (file.is_open() == false)
+		{
+			cerr << "Can't open file: " << grids_file << endl;
+			return RC_FILE_NOT_FOUND;
+		}
+		input = &file;
+	}
+
+	ThreadPool pool(no_of_threads);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (getline(*input, grid))
+	{
+		line_no++;
+		if ((grid.empty() == false) && (grid[grid.length() - 1] == '\r'))
+		{
+			grid.erase(grid.length() - 1);
+		}
+		if (grid.empty())
+		{
+			continue;
+		}
+
+		if (ParseGrid(grid.c_str(), &x_len, &y_len, NULL) != RC_NO_ERROR)
+		{
+			cerr << "Invalid grid at line " << line_no << ": " << grid << endl;
+			grids.push_back(string());
+			outputs.push_back("invalid grid\n\n");
+		}
+		else
+		{
+			grids.push_back(grid);
+			outputs.push_back(string());
+			no_of_grids++;
+		}
+
+		if (grids.size() == CHUNK_SIZE)
+		{
+			solve_chunk(dictionary, pool, grids, outputs, paths);
+		}
+	}
+	solve_chunk(dictionary, pool, grids, outputs, paths);
+	cout.flush();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	cerr << no_of_grids << " grids solved in " << seconds << " s (" << ((seconds > 0) ? (no_of_grids / seconds) : 0) << " grids/sec, " << pool.GetNoOfThreads() << " threads)" << endl;
+	if (dictionary.GetCache() != NULL)
+	{
+		cerr << "result cache: " << dictionary.GetCache()->GetHits() << " hits, " << dictionary.GetCache()->GetMisses() << " misses" << endl;
+	}
+
+	return RC_NO_ERROR;
 }
 
-int main (int argc, char* argv[])
+/* solve one grid (on a pool of threads if no_of_threads != 0; < 0 - one thread per core; paths - each word is followed *
+ * by its path)                                                                                                        */
+static return_code solve_grid (const Dictionary& dictionary, const char *grid, int no_of_threads, bool paths)
+{
+	using std::cout;
+
+	StreamSink sink(cout, paths);
+	std::unique_ptr<ThreadPool> pool;
+	return_code ret_code;
+	int no_found_words = 0;
+
+	if (no_of_threads != 0)
+	{
+		pool.reset(new ThreadPool((no_of_threads > 0) ? no_of_threads : 0));
+	}
+
+	ret_code = Solve(dictionary, grid, sink, &no_found_words, pool.get());
+	sink.Flush();
+	if (ret_code == RC_NO_ERROR)
+	{
+		cout << no_found_words << " words found\n";
+	}
+
+	return ret_code;
+}
+
+/* check mode: check words (e.g. a player's submitted words) against one grid - each word is printed with "found" *
+ * (in the word list and traced on the grid) or "not found", followed by "<n> of <m> words found"                 */
+static return_code check_words (const Dictionary& dictionary, const char *grid, int no_of_words, char *words[])
+{
+	using std::cout;
+
+	vector<string> checked(words, words + no_of_words);
+	vector<bool> found;
+	return_code ret_code;
+	size_t i, no_found_words = 0;
+
+	ret_code = CheckWords(dictionary, grid, checked, found);
+	if (ret_code != RC_NO_ERROR)
+	{
+		return ret_code;
+	}
+
+	for (i = 0; i < checked.size(); i++)
+	{
+		cout << checked[i] << (found[i] ? " found\n" : " not found\n");
+		no_found_words += found[i] ? 1 : 0;
+	}
+	cout << no_found_words << " of " << checked.size() << " words found\n";
+
+	return RC_NO_ERROR;
+}
+
+/* generate mode: the best boards found under a time budget, best first - one per line with its number of found words *
+ * and their total length; the number of boards and threads goes to standard error                                  */
+static return_code generate_boards (const Dictionary& dictionary, GenerateOptions& options, int no_of_threads)
 {
 	using std::cout;
 	using std::cerr;
 	using std::endl;
 
-	WordsGrid<GRID_X_LEN,GRID_Y_LEN> words_grid;
+	ThreadPool pool(no_of_threads);
+	vector<GeneratedBoard> boards;
 	return_code ret_code;
 
+	if ((options.x_len * options.y_len) > GenerateOptions::MAX_CELLS)
+	{
+		cerr << "Board too large: " << options.x_len << "x" << options.y_len << " (generated boards are limited to " << GenerateOptions::MAX_CELLS << " cells)" << endl;
+		return RC_INVALID_GRID;
+	}
+
+	options.seed = std::random_device()();
+	ret_code = GenerateBoards(dictionary, options, boards, &pool);
+	if (ret_code != RC_NO_ERROR)
+	{
+		return ret_code;
+	}
+
+	for (const GeneratedBoard& board : boards)
+	{
+		cout << board.grid << " " << board.score.no_of_words << " words " << board.score.total_length << " letters\n";
+	}
+	cout.flush();
+	cerr << boards.size() << " boards generated in " << options.seconds << " s (" << pool.GetNoOfThreads() << " threads)" << endl;
+
+	return RC_NO_ERROR;
+}
+
+int main (int argc, char* argv[])
+{
+	using std::cout;
+	using std::cerr;
+	using std::endl;
+
+	return_code ret_code = RC_NO_ERROR;
+	int x_len, y_len, i;
+
+	/* -d <backend>, -c <grids> and -p (before any other argument) - the word list backend to search with, the size of *
+	 * the result cache (0 - no cache) and whether each found word is printed with its path (cell indices)               */
+	int backend = Dictionary::BACKEND_DAWG, cache_size = 0;
+	bool paths = false;
+	while ((argc >= 3) && ((strcmp(argv[1], "-d") == 0) || (strcmp(argv[1], "-c") == 0) || (strcmp(argv[1], "-p") == 0)))
+	{
+		if (strcmp(argv[1], "-p") == 0)
+		{
+			paths = true;
+			argc--;
+			argv++;
+			continue;
+		}
+
+		if (strcmp(argv[1], "-d") == 0)
+			for (backend = 0; (backend < Dictionary::NO_OF_BACKENDS) && (strcmp(argv[2], backend_names[backend]) != 0); backend++);
+		else
+			cache_size = std::max(0, atoi(argv[2]));
+		argc -= 2;
+		argv += 2;
+	}
+
+	/* -j <threads> (before the mode) - the grid is searched on a pool of threads; batch and generate modes take it *
+	 * as their own -j <threads> (but not both)                                                                        */
+	const char *threads_arg = NULL;
+	if ((argc >= 5) && (strcmp(argv[1], "-j") == 0))
+	{
+		threads_arg = argv[2];
+		argc -= 2;
+		argv += 2;
+	}
+
+	/* batch [-j <threads>] <word-list-file> [<grids-file>] - 2 more arguments if -j <threads> is given */
+	int j_args = ((argc >= 4) && (strcmp(argv[2], "-j") == 0)) ? 2 : 0;
+
+	/* the word list file, grid and grids file to solve (grid == NULL - batch mode) or the address to serve on *
+	 * or the words to check against the grid (check mode) or the boards to generate (generate mode)          */
+	const char *word_list_file = NULL, *grid = NULL, *grids_file = NULL, *server_address = NULL;
+	char **check = NULL;
+	int no_of_threads = 0, no_of_check_words = 0;
+	GenerateOptions generate = { 0, 0, GenerateOptions::MOST_WORDS, 0, 0, 0, 0 };
+	bool generate_mode = false;
+
 #ifndef _MY_DEBUG_
-	if ((argc != 3) || (strlen(argv[2]) != (GRID_X_LEN * GRID_Y_LEN)))
+	if ((argc == 4) && (strcmp(argv[1], "compile") == 0) && (threads_arg == NULL))
+	{
+		ret_code = compile_word_list(argv[2], argv[3]);
+	}
+	else if ((argc == 4) && (strcmp(argv[1], "serve") == 0) && (backend != Dictionary::NO_OF_BACKENDS) && (threads_arg == NULL))
+	{
+		word_list_file = argv[2];
+		server_address = argv[3];
+	}
+	else if ((argc >= 5) && (strcmp(argv[1], "check") == 0) && (ParseGrid(argv[3], &x_len, &y_len, NULL) == RC_NO_ERROR) && (backend != Dictionary::NO_OF_BACKENDS) &&
+	         (threads_arg == NULL))
+	{
+		word_list_file = argv[2];
+		grid = argv[3];
+		check = &argv[4];
+		no_of_check_words = argc - 4;
+	}
+	else if ((argc >= (6 + j_args)) && (argc <= (7 + j_args)) && (strcmp(argv[1], "generate") == 0) && (backend != Dictionary::NO_OF_BACKENDS) &&
+	         (sscanf(argv[3 + j_args], "%dx%d", &generate.x_len, &generate.y_len) == 2) && (atof(argv[4 + j_args]) > 0) && (atoi(argv[5 + j_args]) > 0) &&
+	         ((argc == (6 + j_args)) || (strcmp(argv[6 + j_args], "words") == 0) || (strcmp(argv[6 + j_args], "length") == 0) || (atoi(argv[6 + j_args]) > 0)) &&
+	         ((threads_arg == NULL) || (j_args == 0)))
+	{
+		word_list_file = argv[2 + j_args];
+		no_of_threads = j_args ? atoi(argv[3]) : (threads_arg ? atoi(threads_arg) : 0);
+		generate.seconds = atof(argv[4 + j_args]);
+		generate.no_of_boards = (size_t)atoi(argv[5 + j_args]);
+		if ((argc == (7 + j_args)) && (strcmp(argv[6 + j_args], "length") == 0))
+		{
+			generate.objective = GenerateOptions::LONGEST_WORDS;
+		}
+		else if ((argc == (7 + j_args)) && (strcmp(argv[6 + j_args], "words") != 0))
+		{
+			generate.objective = GenerateOptions::TARGET_WORDS;
+			generate.target_words = atoi(argv[6 + j_args]);
+		}
+		generate_mode = true;
+	}
+	else if ((argc >= (3 + j_args)) && (argc <= (4 + j_args)) && (strcmp(argv[1], "batch") == 0) && (backend != Dictionary::NO_OF_BACKENDS) &&
+	         ((threads_arg == NULL) || (j_args == 0)))
 	{
-		cout << "Usage: word_search.exe <word-list-file> <gird-as-" << GRID_X_LEN * GRID_Y_LEN << "-chars-string>\n";
+		word_list_file = argv[2 + j_args];
+		grids_file = (argc == (4 + j_args)) ? argv[3 + j_args] : NULL;
+		no_of_threads = j_args ? atoi(argv[3]) : (threads_arg ? atoi(threads_arg) : 0);
+	}
+	else if ((argc != 3) || (ParseGrid(argv[2], &x_len, &y_len, NULL) != RC_NO_ERROR) || (backend == Dictionary::NO_OF_BACKENDS))
+	{
+		cout << "Usage: word_search.exe [-d <backend>] [-c <grids>] [-p] [-j <threads>] <word-list-file> <grid> (square grid as one string, e.g. 16 chars for 4x4, or rows separated by '/', e.g. abc/def/ghi/jkl or abcd/)\n";
+		cout << "       word_search.exe [-d <backend>] [-c <grids>] [-p] batch [-j <threads>] <word-list-file> [<grids-file>] (one grid per line, standard input if not given)\n";
+		cout << "       word_search.exe [-d <backend>] check <word-list-file> <grid> <word>... (is each word in the word list and on the grid)\n";
+		cout << "       word_search.exe [-d <backend>] [-c <grids>] serve <word-list-file> <port or socket-path> (solver server, see README.txt)\n";
+		cout << "       word_search.exe [-d <backend>] generate [-j <threads>] <word-list-file> <rows>x<columns> <seconds> <boards> [words|length|<target-words>]\n";
+		cout << "           (the best boards found in <seconds>: most found words (default), longest found words or found words closest to <target-words>)\n";
+		cout << "       word_search.exe compile <word-list-file> <image-file>\n";
+		cout << "       <backend>:";
+		for (i = 0; i < Dictionary::NO_OF_BACKENDS; i++)
+		{
+			cout << " " << backend_names[i];
+		}
+		cout << " (default: " << backend_names[Dictionary::BACKEND_DAWG] << ")\n";
+		cout << "       <grids>: result cache size - repeated, rotated or reflected grids are answered from it (default: 0 - no cache)\n";
+		cout << "       -p: every found word is followed by its path - the cells that spell it (cell index = row * columns + column)\n";
+		return 0;
 	}
 	else
-#endif
 	{
-#ifndef _MY_DEBUG_
-		ret_code = words_grid.InitWordList(argv[1]);
-#else
-		ret_code = words_grid.InitWordList("word_x.list");
-#endif
-		if (ret_code != RC_FILE_NOT_FOUND)
+		word_list_file = argv[1];
+		grid = argv[2];
+		if (threads_arg != NULL)
 		{
-			if (ret_code == RC_EOF)
-			{
-#ifndef _MY_DEBUG_
-				words_grid.SetGrid(argv[2]);
+			no_of_threads = atoi(threads_arg);
+			if (no_of_threads <= 0)
+				no_of_threads = -1; /* -j 0: one thread per core */
+		}
+	}
 #else
-				words_grid.SetGrid("mikayuvaaahlmich"); // more examples: aahebcidbengmika, abombanilenesess, mikayuvaaahlmich
+	word_list_file = "word_x.list";
+	grid = "mikayuvaaahlmich"; // more examples: aahebcidbengmika, abombanilenesess, mikayuvaaahlmich
 #endif
 
-				words_grid.SetOutputFunc(words_grid_output_func);
-				words_grid.OutputFoundWords();
-				cout << words_grid.GetNoFoundWords() << " words found\n";
-			 
-				ret_code = RC_NO_ERROR;
-			}
-		}
+	if (word_list_file != NULL)
+	{
+		Dictionary dictionary((Dictionary::Backend)backend);
 
-		if (ret_code != RC_NO_ERROR)
+		dictionary.SetCacheSize(cache_size);
+		if ((backend != Dictionary::BACKEND_DAWG) && WordListDawg::WordList::IsImage(word_list_file))
+		{
+			cerr << "Compiled image files load only with -d " << backend_names[Dictionary::BACKEND_DAWG] << ": " << word_list_file << endl;
+			ret_code = RC_BAD_IMAGE;
+		}
+		else
+		{
+			ret_code = dictionary.Load(word_list_file);
+		}
+		if (ret_code == RC_NO_ERROR)
 		{
-			cerr << "ERROR: error code #" << ret_code << endl;
+			if (server_address != NULL)
+				ret_code = RunServer(dictionary, server_address);
+			else if (check != NULL)
+				ret_code = check_words(dictionary, grid, no_of_check_words, check);
+			else if (generate_mode)
+				ret_code = generate_boards(dictionary, generate, no_of_threads);
+			else if (grid != NULL)
+				ret_code = solve_grid(dictionary, grid, no_of_threads, paths);
+			else
+				ret_code = solve_batch(dictionary, grids_file, no_of_threads, paths);
 		}
 	}
 
+	if (ret_code != RC_NO_ERROR)
+	{
+		cerr << "ERROR: error code #" << ret_code << endl;
+	}
+
 	return 0;
 }
@@ -0,0 +1,135 @@
+#include <string>
+
+#include "result_cache.h"
+
+ResultCache::ResultCache(size_t _max_entries) : max_entries(_max_entries), hits(0), misses(0)
+{
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: CanonicalKey                                                                                              *
+*                                                                                                                     *
+* DESCRIPTION: cache key of a grid - the smallest "<rows>x<columns>/<cells>" of the grid's 8 symmetries               *
+*                                                                                                                     *
+* PARAMETERS: x_len (in) - number of rows                                                                             *
+*             y_len (in) - number of columns                                                                          *
+*             cells (in) - grid characters row by row (x_len x y_len)                                                 *
+*             key (out) - canonical key                                                                               *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: a symmetry is a choice of: transpose (swap rows and columns), reverse the rows, reverse the columns          *
+*        e.g. "ab/cd" (2 x 2) and its rotation "ca/db" have the same key "2x2/abcd"                                   *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void ResultCache::CanonicalKey(int x_len, int y_len, const std::string& cells, std::string& key)
+{
+	std::string candidate;
+	int symmetry, rows, columns, i, j, a, b;
+
+	key.clear();
+	for (symmetry = 0; symmetry < 8; symmetry++)
+	{
+		bool transpose = (symmetry & 1) != 0, reverse_rows = (symmetry & 2) != 0, reverse_columns = (symmetry & 4) != 0;
+
+		rows = transpose ? y_len : x_len;
+		columns = transpose ? x_len : y_len;
+
+		candidate = std::to_string(rows) + "x" + std::to_string(columns) + "/";
+		for (i = 0; i < rows; i++)
+		{
+			for (j = 0; j < columns; j++)
+			{
+				/* source cell (a, b) of the original grid */
+				a = transpose ? j : i;
+				b = transpose ? i : j;
+				if (reverse_rows)
+					a = x_len - 1 - a;
+				if (reverse_columns)
+					b = y_len - 1 - b;
+				candidate.push_back(cells[(a * y_len) + b]);
+			}
+		}
+
+		if ((symmetry == 0) || (candidate < key))
+		{
+			key.swap(candidate);
+		}
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Find                                                                                                      *
+*                                                                                                                     *
+* DESCRIPTION: look up the found words of a grid (and make it the most recently used)                                 *
+*                                                                                                                     *
+* PARAMETERS: key (in) - canonical key of the grid                                                                    *
+*             words (out) - found words (sorted), each followed by '\n'                                               *
+*             no_of_words (out) - number of found words                                                               *
+*                                                                                                                     *
+* RETURN: true - hit; false - miss (words and no_of_words unchanged)                                                  *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+bool ResultCache::Find(const std::string& key, std::string& words, int *no_of_words)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	std::unordered_map<std::string, std::list<entry>::iterator>::iterator found = index.find(key);
+
+	if (found == index.end())
+	{
+		misses++;
+		return false;
+	}
+
+	lru.splice(lru.begin(), lru, found->second);
+	words = found->second->words;
+	*no_of_words = found->second->no_of_words;
+	hits++;
+
+	return true;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Add                                                                                                       *
+*                                                                                                                     *
+* DESCRIPTION: add the found words of a grid (the least recently used grid is dropped when the cache is full)         *
+*                                                                                                                     *
+* PARAMETERS: key (in) - canonical key of the grid                                                                    *
+*             words (in) - found words (sorted), each followed by '\n'                                                *
+*             no_of_words (in) - number of found words                                                                *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: a grid already in the cache (added by another thread meanwhile) is only made the most recently used         *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void ResultCache::Add(const std::string& key, const std::string& words, int no_of_words)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	std::unordered_map<std::string, std::list<entry>::iterator>::iterator found = index.find(key);
+
+	if (max_entries == 0)
+	{
+		return;
+	}
+
+	if (found != index.end())
+	{
+		lru.splice(lru.begin(), lru, found->second);
+		return;
+	}
+
+	if (lru.size() >= max_entries)
+	{
+		index.erase(lru.back().key);
+		lru.pop_back();
+	}
+
+	lru.push_front(entry{ key, words, no_of_words });
+	index.emplace(key, lru.begin());
+}
@@ -0,0 +1,49 @@
+#ifndef _RESULT_CACHE_H_
+#define _RESULT_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/* LRU cache of found words by grid - thread safe (one lock around lookups and updates)                              *
+ * a grid's key is its canonical form: the smallest of the 8 symmetries of the board (rotations and reflections,     *
+ * a rotation of an X x Y board is Y x X), which all have the same found words (adjacency is the full 8-neighborhood) */
+class ResultCache
+{
+private:
+	struct entry
+	{
+		std::string key;
+		std::string words; /* found words (sorted), each followed by '\n' */
+		int no_of_words;
+	};
+
+	/* most recently used first */
+	std::list<entry> lru;
+	std::unordered_map<std::string, std::list<entry>::iterator> index;
+	size_t max_entries;
+	std::mutex lock;
+
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+
+public:
+
+	explicit ResultCache(size_t max_entries);
+	ResultCache(const ResultCache&) = delete;
+	ResultCache& operator=(const ResultCache&) = delete;
+
+	static void CanonicalKey(int x_len, int y_len, const std::string& cells, std::string& key);
+	bool Find(const std::string& key, std::string& words, int *no_of_words);
+	void Add(const std::string& key, const std::string& words, int no_of_words);
+
+	/* statistics */
+	uint64_t GetHits() const { return hits; }
+	uint64_t GetMisses() const { return misses; }
+	size_t GetMaxEntries() const { return max_entries; }
+};
+
+#endif // _RESULT_CACHE_H_
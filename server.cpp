@@ -0,0 +1,344 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+
+#include "gen_defs.h"
+#include "word_search.h"
+#include "server.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*******************************************************************************************************************************************************/
+/************************************************************ internal functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+#ifndef _WIN32
+
+/* connections being served (at most MAX_CONNECTIONS - the accept loop waits for a closed one) */
+static std::mutex connections_lock;
+static std::condition_variable connection_closed;
+static int no_of_connections = 0;
+
+static void put_uint32 (char *data, uint32_t value)
+{
+	data[0] = (char)(value & 0xff);
+	data[1] = (char)((value >> 8) & 0xff);
+	data[2] = (char)((value >> 16) & 0xff);
+	data[3] = (char)((value >> 24) & 0xff);
+}
+
+static uint32_t get_uint32 (const char *data)
+{
+	return (uint32_t)(unsigned char)data[0] | ((uint32_t)(unsigned char)data[1] << 8) | ((uint32_t)(unsigned char)data[2] << 16) | ((uint32_t)(unsigned char)data[3] << 24);
+}
+
+/* a port number address (all digits) - TCP on 127.0.0.1, any other address - Unix domain socket path */
+static bool is_port (const char *address)
+{
+	return (*address != '\0') && (strspn(address, "0123456789") == strlen(address));
+}
+
+static bool read_all (int connection, char *data, size_t size)
+{
+	ssize_t n;
+
+	while (size > 0)
+	{
+		n = read(connection, data, size);
+		if ((n < 0) && (errno == EINTR))
+			continue;
+		if (n <= 0)
+			return false;
+
+		data += n;
+		size -= (size_t)n;
+	}
+
+	return true;
+}
+
+static bool write_all (int connection, const char *data, size_t size)
+{
+	ssize_t n;
+
+	while (size > 0)
+	{
+		n = write(connection, data, size);
+		if ((n < 0) && (errno == EINTR))
+			continue;
+		if (n <= 0)
+			return false;
+
+		data += n;
+		size -= (size_t)n;
+	}
+
+	return true;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: open_socket                                                                                               *
+*                                                                                                                     *
+* DESCRIPTION: open a listening socket (server) or a connected socket (client) of an address                          *
+*                                                                                                                     *
+* PARAMETERS: address (in) - port number or Unix domain socket path                                                   *
+*             listening (in) - true: bind and listen; false: connect                                                  *
+*                                                                                                                     *
+* RETURN: socket (-1 - error, reported to standard error)                                                             *
+*                                                                                                                     *
+* NOTES: a listening Unix domain socket replaces a socket file left at its path by a server that was killed (one     *
+*        that refuses connections) - not the socket of a running server                                               *
+*                                                                                                                     *
+***********************************************************************************************************************/
+static int open_socket (const char *address, bool listening)
+{
+	struct sockaddr_in tcp_address;
+	struct sockaddr_un unix_address;
+	struct sockaddr *socket_address;
+	struct stat file_stat;
+	socklen_t address_len;
+	int fd, probe, option = 1;
+	bool stale;
+
+	if (is_port(address))
+	{
+		memset(&tcp_address, 0, sizeof(tcp_address));
+		tcp_address.sin_family = AF_INET;
+		tcp_address.sin_port = htons((uint16_t)atoi(address));
+		tcp_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socket_address = (struct sockaddr*)&tcp_address;
+		address_len = sizeof(tcp_address);
+	}
+	else
+	{
+		if (strlen(address) >= sizeof(unix_address.sun_path))
+		{
+			std::cerr << "Socket path too long: " << address << std::endl;
+			return -1;
+		}
+		memset(&unix_address, 0, sizeof(unix_address));
+		unix_address.sun_family = AF_UNIX;
+		strcpy(unix_address.sun_path, address);
+		socket_address = (struct sockaddr*)&unix_address;
+		address_len = sizeof(unix_address);
+	}
+
+	fd = socket(socket_address->sa_family, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		std::cerr << "Can't open socket: " << strerror(errno) << std::endl;
+		return -1;
+	}
+
+	if (socket_address->sa_family == AF_INET)
+	{
+		/* small frames - don't wait to coalesce them */
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+		if (listening)
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option));
+	}
+	else if (listening && (stat(address, &file_stat) == 0) && S_ISSOCK(file_stat.st_mode))
+	{
+		/* a socket file is taken over only if nothing listens on it anymore (connecting to it is refused) */
+		probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		stale = (probe >= 0) && (connect(probe, socket_address, address_len) != 0) && (errno == ECONNREFUSED);
+		if (probe >= 0)
+			close(probe);
+		if (stale == false)
+		{
+			std::cerr << "Can't listen on " << address << ": address in use" << std::endl;
+			close(fd);
+			return -1;
+		}
+		unlink(address);
+	}
+
+	if ((listening && ((bind(fd, socket_address, address_len) != 0) || (listen(fd, SOMAXCONN) != 0))) ||
+	    ((listening == false) && (connect(fd, socket_address, address_len) != 0)))
+	{
+		std::cerr << "Can't " << (listening ? "listen on " : "connect to ") << address << ": " << strerror(errno) << std::endl;
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: serve_connection                                                                                          *
+*                                                                                                                     *
+* DESCRIPTION: answer the requests of a connection (one at a time, in order) until it is closed                       *
+*                                                                                                                     *
+* PARAMETERS: dictionary (in) - loaded dictionary                                                                     *
+*             connection (in) - connected socket (closed on return)                                                   *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: runs on its own thread - Solve is reentrant, so connections are served in parallel                          *
+*                                                                                                                     *
+***********************************************************************************************************************/
+static void serve_connection (const Dictionary& dictionary, int connection)
+{
+	/* response header: frame length, return code, number of found words */
+	const size_t HEADER_SIZE = 12;
+
+	std::string request, response;
+	return_code ret_code;
+	int no_found_words;
+
+	while (ReadFrame(connection, request, MAX_REQUEST_SIZE))
+	{
+		response.assign(HEADER_SIZE, '\0');
+		StringSink sink(response);
+
+		no_found_words = 0;
+		ret_code = Solve(dictionary, request.c_str(), sink, &no_found_words);
+
+		put_uint32(&response[0], (uint32_t)(response.size() - 4));
+		put_uint32(&response[4], (uint32_t)ret_code);
+		put_uint32(&response[8], (uint32_t)no_found_words);
+		if (write_all(connection, response.data(), response.size()) == false)
+			break;
+	}
+
+	CloseConnection(connection);
+
+	std::lock_guard<std::mutex> guard(connections_lock);
+	no_of_connections--;
+	connection_closed.notify_one();
+}
+
+#endif // _WIN32
+
+/*******************************************************************************************************************************************************/
+/************************************************************ external functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: RunServer                                                                                                 *
+*                                                                                                                     *
+* DESCRIPTION: serve grid requests on an address with a loaded dictionary (every connection on its own thread)        *
+*                                                                                                                     *
+* PARAMETERS: dictionary (in) - loaded dictionary (read only - shared by all connections)                             *
+*             address (in) - port number or Unix domain socket path                                                   *
+*                                                                                                                     *
+* RETURN: RC_SOCKET_ERROR - can't listen on the address (or accept failed); otherwise runs until killed               *
+*                                                                                                                     *
+* NOTES: Unix domain sockets and TCP only on POSIX systems; at most MAX_CONNECTIONS connections are served at once -  *
+*        no new connection is accepted until one of them is closed (memory: up to MAX_REQUEST_SIZE per connection)    *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code RunServer(const Dictionary& dictionary, const char *address)
+{
+#ifdef _WIN32
+	std::cerr << "Server mode is not supported on this system" << std::endl;
+	return RC_SOCKET_ERROR;
+#else
+	int server, connection;
+
+	signal(SIGPIPE, SIG_IGN); /* a client that closed its connection fails the write instead */
+
+	server = open_socket(address, true);
+	if (server < 0)
+	{
+		return RC_SOCKET_ERROR;
+	}
+	std::cerr << "Listening on " << address << std::endl;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> guard(connections_lock);
+			connection_closed.wait(guard, [] { return no_of_connections < MAX_CONNECTIONS; });
+		}
+
+		connection = accept(server, NULL, NULL);
+		if (connection < 0)
+		{
+			if ((errno == EINTR) || (errno == ECONNABORTED))
+				continue;
+
+			std::cerr << "Can't accept connection: " << strerror(errno) << std::endl;
+			close(server);
+			return RC_SOCKET_ERROR;
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(connections_lock);
+			no_of_connections++;
+		}
+		std::thread(serve_connection, std::cref(dictionary), connection).detach();
+	}
+#endif
+}
+
+/* connect to a server: the connection (-1 - error, reported to standard error) */
+int ConnectServer(const char *address)
+{
+#ifdef _WIN32
+	std::cerr << "Server mode is not supported on this system" << std::endl;
+	return -1;
+#else
+	return open_socket(address, false);
+#endif
+}
+
+void CloseConnection(int connection)
+{
+#ifndef _WIN32
+	close(connection);
+#endif
+}
+
+/* read one frame (false - connection closed, read error or frame longer than max_size) */
+bool ReadFrame(int connection, std::string& frame, uint32_t max_size)
+{
+#ifdef _WIN32
+	return false;
+#else
+	char header[4];
+	uint32_t size;
+
+	if (read_all(connection, header, sizeof(header)) == false)
+		return false;
+
+	size = get_uint32(header);
+	if (size > max_size)
+		return false;
+
+	frame.resize(size);
+	return read_all(connection, &frame[0], size);
+#endif
+}
+
+/* write one frame (one write call for the length and the data) */
+bool WriteFrame(int connection, const char *data, size_t size)
+{
+#ifdef _WIN32
+	return false;
+#else
+	std::string frame(4, '\0');
+
+	put_uint32(&frame[0], (uint32_t)size);
+	frame.append(data, size);
+	return write_all(connection, frame.data(), frame.size());
+#endif
+}
@@ -0,0 +1,37 @@
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "gen_defs.h"
+
+class Dictionary;
+
+/* solver server protocol (over a Unix domain socket or a TCP loopback port):                                          *
+ * every message is a frame: 4 byte length (little endian) + that many bytes                                          *
+ * request:  grid string (see ParseGrid)                                                                               *
+ * response: 4 byte return code (RC_NO_ERROR or RC_INVALID_GRID) + 4 byte number of found words (little endian) +     *
+ *           the found words, each followed by '\n'                                                                   *
+ * requests may be pipelined - a connection's responses come in the order of its requests                            *
+ * address: a port number (e.g. "7070" - 127.0.0.1:7070) or a Unix domain socket path (e.g. "/tmp/word_search.sock") */
+
+/* largest frame accepted (a longer frame closes the connection) */
+const uint32_t MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+/* largest request the server accepts - a grid string (a grid of the most cells, 65536, fits with room to spare) */
+const uint32_t MAX_REQUEST_SIZE = 1024 * 1024;
+
+/* connections the server serves at once (a thread each) - a connection beyond waits in the listen queue until one of *
+ * them is closed                                                                                                     */
+const int MAX_CONNECTIONS = 64;
+
+return_code RunServer(const Dictionary& dictionary, const char *address);
+
+/* client side (also used by the server) */
+int ConnectServer(const char *address);
+void CloseConnection(int connection);
+bool ReadFrame(int connection, std::string& frame, uint32_t max_size = MAX_FRAME_SIZE);
+bool WriteFrame(int connection, const char *data, size_t size);
+
+#endif // _SERVER_H_
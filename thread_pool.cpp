@@ -0,0 +1,231 @@
+#include <cassert>
+#include <cstdint>
+
+#include "thread_pool.h"
+
+/* pool and index of the pool worker running on this thread (NULL/SIZE_MAX on a thread that is not a pool thread) */
+static thread_local const ThreadPool *current_pool = NULL;
+static thread_local size_t current_worker = SIZE_MAX;
+
+/*******************************************************************************************************************************************************/
+/************************************************************ internal functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: get_task                                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: take a task - the newest task of the worker's own queue, else steal the oldest task of another queue    *
+*                                                                                                                     *
+* PARAMETERS: worker (in) - worker index (workers.size() for a thread that is not a pool worker - steals only)        *
+*             task (out) - task taken                                                                                 *
+*                                                                                                                     *
+* RETURN: true - task taken                                                                                           *
+*         false - all queues are empty                                                                                *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+bool ThreadPool::get_task(size_t worker, Task& task)
+{
+	size_t i, victim;
+
+	if (worker < workers.size())
+	{
+		std::lock_guard<std::mutex> guard(workers[worker]->lock);
+		if (workers[worker]->tasks.empty() == false)
+		{
+			task = std::move(workers[worker]->tasks.back());
+			workers[worker]->tasks.pop_back();
+			queued--;
+			return true;
+		}
+	}
+
+	for (i = 1; i <= workers.size(); i++)
+	{
+		victim = (worker + i) % workers.size();
+		std::lock_guard<std::mutex> guard(workers[victim]->lock);
+		if (workers[victim]->tasks.empty() == false)
+		{
+			task = std::move(workers[victim]->tasks.front());
+			workers[victim]->tasks.pop_front();
+			queued--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: run_task                                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: run a task and wake up Wait if it was the last pending task                                            *
+*                                                                                                                     *
+* PARAMETERS: task (in) - task to run                                                                                 *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void ThreadPool::run_task(Task& task)
+{
+	task();
+	task = nullptr;
+
+	if (--pending == 0)
+	{
+		std::lock_guard<std::mutex> guard(idle_lock);
+		all_done.notify_all();
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: worker_loop                                                                                               *
+*                                                                                                                     *
+* DESCRIPTION: pool thread main loop - run tasks until the pool is destroyed                                          *
+*                                                                                                                     *
+* PARAMETERS: worker (in) - worker index                                                                              *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void ThreadPool::worker_loop(size_t worker)
+{
+	Task task;
+
+	current_pool = this;
+	current_worker = worker;
+
+	for (;;)
+	{
+		if (get_task(worker, task))
+		{
+			run_task(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(idle_lock);
+		idle++;
+		work_available.wait(guard, [this] { return stop || (queued > 0); });
+		idle--;
+		if (stop && (queued == 0))
+			break;
+	}
+}
+
+/*******************************************************************************************************************************************************/
+/************************************************************ external functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+ThreadPool::ThreadPool(int no_of_threads) : queued(0), pending(0), idle(0), next_worker(0), stop(false)
+{
+	size_t i;
+
+	if (no_of_threads <= 0)
+	{
+		no_of_threads = (int)std::thread::hardware_concurrency();
+		if (no_of_threads <= 0)
+			no_of_threads = 1;
+	}
+
+	for (i = 0; i < (size_t)no_of_threads; i++)
+	{
+		workers.push_back(std::unique_ptr<Worker>(new Worker));
+	}
+	threads.reserve(no_of_threads);
+	for (i = 0; i < (size_t)no_of_threads; i++)
+	{
+		threads.push_back(std::thread(&ThreadPool::worker_loop, this, i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(idle_lock);
+		stop = true;
+	}
+	work_available.notify_all();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Submit                                                                                                    *
+*                                                                                                                     *
+* DESCRIPTION: add a task to the pool                                                                                 *
+*                                                                                                                     *
+* PARAMETERS: task (in) - task to run on one of the pool threads                                                      *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: a task submitted by a task goes to its own worker's queue, other tasks are spread over all queues            *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void ThreadPool::Submit(Task task)
+{
+	size_t worker;
+
+	if (current_pool == this)
+		worker = current_worker;
+	else
+		worker = next_worker++ % workers.size();
+
+	pending++;
+	{
+		std::lock_guard<std::mutex> guard(workers[worker]->lock);
+		workers[worker]->tasks.push_back(std::move(task));
+		queued++;
+	}
+
+	/* a thread in Wait runs tasks too - wake it as well (e.g. for the subtasks a task submits) */
+	std::lock_guard<std::mutex> guard(idle_lock);
+	work_available.notify_one();
+	all_done.notify_all();
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Wait                                                                                                      *
+*                                                                                                                     *
+* DESCRIPTION: wait until all submitted tasks are done (the calling thread runs tasks as well meanwhile)              *
+*                                                                                                                     *
+* PARAMETERS: none                                                                                                    *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: must not be called from a task; waits for every task of the pool - also for the tasks other threads          *
+*        submitted meanwhile, so threads that share one pool wait for each other's tasks too                          *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void ThreadPool::Wait()
+{
+	Task task;
+
+	assert(current_pool != this);
+
+	while (pending > 0)
+	{
+		if (get_task(workers.size(), task))
+		{
+			run_task(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(idle_lock);
+		idle++;
+		all_done.wait(guard, [this] { return (pending == 0) || (queued > 0); });
+		idle--;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* work stealing thread pool: every worker has its own task queue, an idle worker steals from the others' queues    *
+ * the pending tasks are counted for the whole pool: Wait returns once no task of any submitter is left             */
+class ThreadPool
+{
+public:
+	typedef std::function<void()> Task;
+
+private:
+	/* worker's task queue (owner pops the newest task, thieves steal the oldest) */
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker> > workers;
+	std::vector<std::thread> threads;
+
+	/* idle workers (and Wait) sleep here */
+	std::mutex idle_lock;
+	std::condition_variable work_available;
+	std::condition_variable all_done;
+
+	std::atomic<size_t> queued;  /* tasks in queues */
+	std::atomic<size_t> pending; /* tasks submitted and not finished yet */
+	std::atomic<size_t> idle;    /* threads (workers and Wait) sleeping for a task */
+	std::atomic<size_t> next_worker;
+	bool stop;
+
+	bool get_task(size_t worker, Task& task);
+	void run_task(Task& task);
+	void worker_loop(size_t worker);
+
+public:
+
+	explicit ThreadPool(int no_of_threads = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(Task task);
+	void Wait();
+	/* a thread is sleeping for a task and none is queued - a running task may split off some of its work */
+	bool IsStarving() const { return (idle > 0) && (queued == 0); }
+	int GetNoOfThreads() const { return (int)threads.size(); }
+};
+
+#endif // _THREAD_POOL_H_
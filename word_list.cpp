@@ -1,12 +1,18 @@
 #include <cassert>
+#include <algorithm>
+#include <new>
 
 #include "gen_defs.h"
 #include "word_list.h"
+#include "file_map.h"
+
+static bool next_line(const char **pos, const char *end, std::string_view *line);
+static return_code read_words(const char *file_name, FileMap& file, std::vector<std::string_view>& words);
 
 /*
  CONCEPT: word list as a tree of character nodes
 
- e.g. word list with the following words (. means IS_WORD is true; -> mean NEXT pointer; | (n times) means ADJACENT pointer): 
+ e.g. word list with the following words (. means IS_WORD is true; -> mean NEXT link; | (n times) means ADJACENT link): 
  aa
  aah
  aahed
@@ -23,6 +29,8 @@
 			  |   s.
 			  |
 			  l.->i->i.->s.    
+
+ nodes are allocated from large slabs (never one by one) and NEXT/ADJACENT are 32 bit node indices - Head is node 0
  */
 
 /*******************************************************************************************************************************************************/
@@ -31,238 +39,120 @@
 
 /***********************************************************************************************************************
  *                                                                                                                     *
- * FUNCTION: add_word_to_char_tree                                                                                      *
+ * FUNCTION: alloc_char_node                                                                                           *
  *                                                                                                                     *
- * DESCRIPTION: Add new word to character tree                                                                         *
- *              (called in a loop for every word read from word list file to be added to the character tree)           *
+ * DESCRIPTION: take a new character node from the current slab (a new slab is allocated when it is full)              *
  *                                                                                                                     *
- * PARAMETERS: char_tree - (in/out) pointer to character tree pointer                                                  *
- *             word  - (in) word to be added                                                                           *
- *             allocated_nodes - (out) number of new nodes allocated as a result                                       *
+ * PARAMETERS: ch  - (in) node's character                                                                             *
  *                                                                                                                     *
- * RETURN: RC_NO_ERROR - no error                                                                                      *
- *         RC_NO_MEM - error, no memory (nodes could not be allocated)                                                 *
+ * RETURN: index of the new node (not linked, not a word)                                                              *
+ *         NO_INDEX - error, no memory (slab could not be allocated)                                                   *
  *                                                                                                                     *
- * NOTES:                                                                                                              *
+ * NOTES: a new slab doesn't move the nodes of the other slabs (pointers to nodes stay valid)                          *
  *                                                                                                                     *
  ***********************************************************************************************************************/
-return_code WordListTree::WordList::add_word_to_char_tree (const string& word)
+uint32_t WordListTree::WordList::alloc_char_node (char ch)
 {
-   CharNode *nxt_search = char_tree;
-   CharNode *nxt_search_prev = NULL;
-   CharNode *adj_search;
-   CharNode *adj_adj_search;
-   CharNode *char_node;
-   size_t i, word_len;
-   bool is_word, char_added_to_adjacent;
-
-   word_len = word.length();
-   for (i = 0; i < word_len; i++)
-   {
-	  is_word = (i == (word_len - 1));
-
-	  /* no charaters exist in this depth */
-	  if (nxt_search == NULL)
-	  {
-		 char_node = new CharNode(word[i], is_word);
-		 if (char_node == NULL)
-		 {
-			return RC_NO_MEM;
-		 }
-		allocated_nodes++;
-
-		nxt_search = char_node;
-		 
-		 /* initialise word list if the very first character */
-         if (char_tree == NULL)
-		 {
-            char_tree = char_node;
-		 }
-		 else
-		 {
-			assert(nxt_search_prev);
-
-			nxt_search_prev->next = nxt_search;
-		 }
+   uint32_t index;
 
-		 nxt_search_prev = nxt_search;
-		 nxt_search = nxt_search->next;
-	  }
-	  
-	  /* characters do exist in this depth */
-	  else
+   if ((no_of_slab_nodes & (SLAB_SIZE - 1)) == 0)
+   {
+	  CharNode *slab = new (std::nothrow) CharNode[SLAB_SIZE];
+	  if (slab == NULL)
 	  {
-		 char_added_to_adjacent = false;
-		 
-		 /* search ADJACENT list to find the correct spot to add character to list (if character does not exist) - ADJACENT list is kept sorted by character value */
-		 for (adj_search = nxt_search; !char_added_to_adjacent; adj_search = adj_search->adjacent)
-		 {
-			assert(adj_search);
-			adj_adj_search = adj_search->adjacent;
-			
-			if (adj_search->ch == (word[i]))
-			{
-			   nxt_search_prev = adj_search;
-			   nxt_search = nxt_search_prev->next;
-			   char_added_to_adjacent = true; /* character already exists - do nothing */
-			}
-			
-			else if (adj_search->ch < (word[i]))
-			{
-			   if (adj_adj_search == NULL)
-			   {
-				  /* add character to the end of ADJACENT list */
-				  char_node = new CharNode(word[i], is_word);
-				  if (char_node == NULL)
-				  {
-					 return RC_NO_MEM;
-				  }
-				  allocated_nodes++;
-
-				  adj_search->adjacent = char_node;
-
-				  nxt_search_prev = char_node;
-				  nxt_search = nxt_search_prev->next;
-				  char_added_to_adjacent = true;
-
-			   }
-			   else if (adj_adj_search->ch > (word[i]))
-			   {
-				  /* add character between adj_search and adj_adj_search */
-				  char_node = new CharNode(word[i], is_word);
-				  if (char_node == NULL)
-				  {
-					 return RC_NO_MEM;
-				  }
-				  allocated_nodes++;
-
-				  adj_search->adjacent = char_node;
-				  char_node->adjacent = adj_adj_search;
-
-				  nxt_search_prev = char_node;
-				  nxt_search = nxt_search_prev->next;
-				  char_added_to_adjacent = true;
-			   }
-			   /* else (adj_adj_search->ch <= (word[i])) - to be handled in the next loop iteration */
-			}
-			else /* (adj_search->ch > (word[i])) */
-			{
-			   /* add character at the start of ADJACENT list */
-			   char_node = new CharNode(word[i], is_word);
-			   if (char_node == NULL)
-			   {
-				  return RC_NO_MEM;
-			   }
-			   allocated_nodes++;
-
-			   nxt_search_prev->next = char_node;
-			   char_node->adjacent = nxt_search;
-
-			   nxt_search_prev = char_node;
-			   nxt_search = nxt_search_prev->next;
-			   char_added_to_adjacent = true;
-			}
-		 }
+		 return NO_INDEX;
 	  }
-
+	  slabs.emplace_back(slab);
    }
 
-   return RC_NO_ERROR;
+   index = no_of_slab_nodes++;
+   *char_node(index) = CharNode{ ch, false, 0, ALL_LETTERS, 0, NO_INDEX, NO_INDEX };
+
+   return index;
 }
 
 /***********************************************************************************************************************
  *                                                                                                                     *
- * FUNCTION: WordList_FindWord                                                                                         *
+ * FUNCTION: add_word_to_char_tree                                                                                      *
  *                                                                                                                     *
- * DESCRIPTION: search to find a word in a word list's character tree                                                  *
+ * DESCRIPTION: Add new word to character tree                                                                         *
+ *              (called in a loop for every word read from word list file to be added to the character tree)           *
  *                                                                                                                     *
- * PARAMETERS: char_tree (in) - pointer to character tree of word list to search the word from                         *
- *             word (in) - word to search/find                                                                         *
+ * PARAMETERS: word  - (in) word to be added                                                                           *
  *                                                                                                                     *
- * RETURN: WORD_FOUND - word is found                                                                                  *
- *         PREFIX_FOUND - word is found as a prefix of another word (e.g. "aband" as a prefix of "abandon")            *
- *         NOT_FOUND - word not found (also not found as a prefix)                                                     *
+ * RETURN: RC_NO_ERROR - no error                                                                                      *
+ *         RC_NO_MEM - error, no memory (nodes could not be allocated)                                                 *
  *                                                                                                                     *
  * NOTES:                                                                                                              *
  *                                                                                                                     *
  ***********************************************************************************************************************/
-int WordListTree::WordList::find_word (CharNode *search_tree, const char *word) const
+return_code WordListTree::WordList::add_word_to_char_tree (std::string_view word)
 {
-   size_t word_len;
-   CharNode *search;
-   
-   word_len = strlen(word);
-
-   assert(word_len);
-   
-   for (search = search_tree; search != NULL; search = search->adjacent)
+   uint32_t prefix = ROOT_INDEX;
+   uint32_t *link;
+   uint32_t new_node;
+   size_t i;
+
+   for (i = 0; i < word.length(); i++)
    {
-	  if (search->ch == word[0])
+	  /* search the NEXT list of prefix (kept sorted by character value through ADJACENT) for the character's spot */
+	  for (link = &char_node(prefix)->next; (*link != NO_INDEX) && (char_node(*link)->ch < word[i]); link = &char_node(*link)->adjacent);
+
+	  if ((*link == NO_INDEX) || (char_node(*link)->ch != word[i]))
 	  {
-		 if (word_len == 1)
-		 {
-			 if (search->is_word)
-			 {
-				 return WORD_FOUND;
-			 }
-			 else 
-			 {
-				 return PREFIX_FOUND;
-			 }
-		 }
-		 else
+		 /* add character before the first greater one (or at the end of the list) */
+		 new_node = alloc_char_node(word[i]);
+		 if (new_node == NO_INDEX)
 		 {
-			return find_word(search->next, word+1);
+			return RC_NO_MEM;
 		 }
+		 allocated_nodes++;
+
+		 char_node(new_node)->adjacent = *link;
+		 *link = new_node;
 	  }
-	  else if (search->ch > word[0])
-	  {
-		 return NOT_FOUND;
-	  }
-	  /* else - search->ch < word[0] - continue */
+
+	  prefix = *link;
+   }
+
+   /* a new word (not read before) - mark it as a word end (e.g. "aband" read after "abandon") and give it the next word id */
+   if ((word.length() > 0) && (char_node(prefix)->word_id == 0))
+   {
+	  char_node(prefix)->is_word = true;
+	  char_node(prefix)->word_id = ++no_of_word_ids;
    }
 
-   return NOT_FOUND;
+   return RC_NO_ERROR;
 }
 
 /***********************************************************************************************************************
  *                                                                                                                     *
- * FUNCTION: WordList_FreeCharTree                                                                                     *
+ * FUNCTION: set_required_letters                                                                                      *
  *                                                                                                                     *
- * DESCRIPTION: free memory dynamically allocated for word list's character tree                                       *
+ * DESCRIPTION: set the required letters and next characters (see RequiredLetters, NextChars) of a node and of all    *
+ *              nodes below it                                                                                         *
  *                                                                                                                     *
- * PARAMETERS: char_tree (in) - pointer to character tree                                                              *
+ * PARAMETERS: index  - (in) node index                                                                                *
  *                                                                                                                     *
- * RETURN: none                                                                                                        *
+ * RETURN: required letters of the node                                                                                *
  *                                                                                                                     *
- * NOTES: must be called to free memory at the end of word list life cycle                                             *
+ * NOTES: a node's letters are the letters all its NEXT list characters' words need (each its character and the       *
+ *        letters below it) - recursion depth is the length of the longest word                                       *
  *                                                                                                                     *
  ***********************************************************************************************************************/
-size_t WordListTree::WordList::free_char_tree (CharNode *char_tree)
+uint32_t WordListTree::WordList::set_required_letters (uint32_t index)
 {
-	size_t no_of_freed_nodes = 0;
-
-	if (char_tree != NULL)
-	{
-		if (char_tree->next != NULL)
-		{
-			no_of_freed_nodes += free_char_tree(char_tree->next);
-		}
-
-		if (char_tree->adjacent != NULL)
-		{
-			no_of_freed_nodes += free_char_tree(char_tree->adjacent);
-		}
-
-		char_tree->next = NULL;
-		char_tree->adjacent = NULL;
-
-		delete char_tree;
+   uint32_t letters = ALL_LETTERS, chars = 0;
+   uint32_t child;
 
-		no_of_freed_nodes++;
-	}
+   for (child = char_node(index)->next; child != NO_INDEX; child = char_node(child)->adjacent)
+   {
+	  letters &= letter_bit(char_node(child)->ch) | set_required_letters(child);
+	  chars |= char_bit(char_node(child)->ch);
+   }
 
-	return no_of_freed_nodes;
+   char_node(index)->next_chars = chars;
+   return char_node(index)->required_letters = char_node(index)->is_word ? 0 : letters;
 }
 
 
@@ -272,16 +162,17 @@ size_t WordListTree::WordList::free_char_tree (CharNode *char_tree)
 
 WordListTree::WordList::WordList()
 {
-	char_tree = NULL;
-
+	no_of_slab_nodes = 0;
+	no_of_word_ids = 0;
 	no_of_words = 0;
 	allocated_nodes = 0;
-	freed_nodes = 0;
+
+	alloc_char_node('\0'); /* the root (ROOT_INDEX) */
 }
 
 WordListTree::WordList::~WordList()
 {
-	freed_nodes = free_char_tree(char_tree);
+	/* the slabs free all nodes at once (no tree walk) */
 }
 
 /***********************************************************************************************************************
@@ -291,41 +182,40 @@ WordListTree::WordList::~WordList()
  * DESCRIPTION: Build character tree for word list from a word list input file                                         *
  *                                                                                                                     *
  * PARAMETERS: word_list (in/out) - pointer to word list to build its character tree                                   *
- *             file - (in) pointer to (already open) input file to read word list from                                 *
- *                          convernsion: <word><LF><word><LF><word><LF>...                                             *
+ *             file_name - (in) word list file name (mapped to memory, words are added straight from the mapping)      *
+ *                          convernsion: <word><LF><word><LF><word><LF>... (CR LF line ends too)                       *
  *                                                                                                                     *
- * RETURN:    RC_NO_MEM - no memory                                                                                    *
+ * RETURN:    RC_FILE_NOT_FOUND - file not found                                                                       *
+ *            RC_NO_MEM - no memory                                                                                    *
  *            RC_EOF - no error (end of file)                                                                          *
  *                                                                                                                     *
- * NOTES:                                                                                                              *
+ * NOTES: only words of characters 'a'..'z' are added (see read_words) and a repeated word is counted once; the       *
+ *        required letters of all nodes are set after the last word (even on an error)                                 *
  *                                                                                                                     *
  ***********************************************************************************************************************/
 return_code WordListTree::WordList::BuildWorldList(const char *file_name)
 {
-	return_code ret_code = RC_EOF;
-	ifstream file;
-	file.open(file_name);
-	if (file.is_open() == false)
+	FileMap file;
+	std::vector<std::string_view> words;
+	return_code ret_code;
+
+	ret_code = read_words(file_name, file, words);
+	if (ret_code != RC_EOF)
 	{
-		std::cerr << "Can't open file: " << file_name << std::endl;
-		return RC_FILE_NOT_FOUND;
+		return ret_code;
 	}
 
-	string word;
-	int count = 0;
-	getline(file, word);
-	while(file) // ToDo: check read failures
+	for (std::string_view word : words)
 	{
 		ret_code = add_word_to_char_tree(word);
 		if (ret_code != RC_NO_ERROR)
 			break;
 		else
 			ret_code = RC_EOF;
-
-		no_of_words++;
-		getline(file, word);
 	}
-	file.close();
+	no_of_words = no_of_word_ids;
+
+	set_required_letters(ROOT_INDEX);
 
 	return ret_code;
 }
@@ -348,81 +238,131 @@ return_code WordListTree::WordList::BuildWorldList(const char *file_name)
  ***********************************************************************************************************************/
 int WordListTree::WordList::FindWord (const char *word) const
 {
-   size_t word_len;
-   CharNode *search;
-   
-   word_len = strlen(word);
-
-   assert(word_len);
-   
-   for (search = char_tree; search != NULL; search = search->adjacent)
+   Node search;
+
+   assert(*word);
+
+   for (search = Root(); *word != '\0'; word++)
    {
-	  if (search->ch == word[0])
-	  {
-		 if (word_len == 1)
-		 {
-			 if (search->is_word)
-			 {
-				 return WORD_FOUND;
-			 }
-			 else 
-			 {
-				 return PREFIX_FOUND;
-			 }
-		 }
-		 else
-		 {
-			return find_word(search->next, word+1);
-		 }
-	  }
-	  else if (search->ch > word[0])
+	  search = Step(search, *word);
+	  if (search == NO_NODE)
 	  {
 		 return NOT_FOUND;
 	  }
-	  /* else - search->ch < word[0] - continue */
    }
 
-   return NOT_FOUND;
+   return IsWord(search) ? WORD_FOUND : PREFIX_FOUND;
 }
 
 /***********************************************************************************************************************
 *                                                                                                                     *
 * FUNCTION: BuildWorldList                                                                                            *
 *                                                                                                                     *
-* DESCRIPTION: Build word list as vector<string> from a word list input file                                          *
+* DESCRIPTION: Build word list as a hash of (prefix node, character) edges from a word list input file                *
 *                                                                                                                     *
 * PARAMETERS: file_name (in) - word list file name                                                                    *
 *                                                                                                                     *
 * RETURN:    RC_FILE_NOT_FOUND - file not found                                                                       *
 *            RC_EOF - no error (end of file)                                                                          *
 *                                                                                                                     *
-* NOTES:                                                                                                              *
+* NOTES: every prefix of every word gets its own node, e.g. "aband" is both a prefix node and a word node             *
+*        only words of characters 'a'..'z' are added (see read_words) and a repeated word is counted once             *
 *                                                                                                                     *
 ***********************************************************************************************************************/
 return_code WordListSet::WordList::BuildWorldList(const char* file_name)
 {
-	ifstream file;
-	file.open(file_name);
-	if (file.is_open() == false)
+	FileMap file;
+	vector<std::string_view> words;
+	return_code ret_code;
+
+	ret_code = read_words(file_name, file, words);
+	if (ret_code != RC_EOF)
 	{
-		std::cerr << "Can't open file: " << file_name << std::endl;
-		return RC_FILE_NOT_FOUND;
+		return ret_code;
 	}
 
-	string word;
-	int count = 0;
-	getline(file, word);
-	while (file) // while input is good
+	for (std::string_view word : words)
 	{
-		list.insert(word);
-		no_of_words++;
-		getline(file, word);
+		add_word(word);
 	}
-	file.close();
+
+	set_required_letters();
 
 	return RC_EOF;
 }
 
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: add_word                                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: add a word (and a node for every prefix of it not added yet)                                           *
+*                                                                                                                     *
+* PARAMETERS: word (in) - word to add (not empty)                                                                     *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: the required letters are not set (see set_required_letters)                                                  *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void WordListSet::WordList::add_word(std::string_view word)
+{
+	Node node;
+	size_t i;
+
+	for (node = Root(), i = 0; i < word.length(); i++)
+	{
+		/* add a new node for the prefix if not there yet (try_emplace - no map node is allocated for an existing edge) */
+		std::pair<unordered_map<uint64_t, uint32_t>::iterator, bool> edge = edges.try_emplace(edge_key(node, word[i]), (uint32_t)is_word.size());
+		if (edge.second)
+		{
+			is_word.push_back(false);
+		}
+		node = edge.first->second;
+	}
+	if (is_word[node] == false)
+	{
+		is_word[node] = true;
+		no_of_words++;
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: set_required_letters                                                                                      *
+*                                                                                                                     *
+* DESCRIPTION: set the required letters and next characters (see RequiredLetters, NextChars) of all nodes             *
+*                                                                                                                     *
+* PARAMETERS: none                                                                                                    *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: a node is numbered after its prefix's node, so the edges are taken by their from node, highest first - the   *
+*        letters of an edge's to node are all set by then                                                             *
+*                                                                                                                     *
+***********************************************************************************************************************/
+void WordListSet::WordList::set_required_letters()
+{
+	vector<std::pair<uint64_t, uint32_t> > sorted_edges(edges.begin(), edges.end());
+	uint32_t node;
+
+	std::sort(sorted_edges.begin(), sorted_edges.end(), [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) { return a.first > b.first; });
+
+	required_letters.resize(is_word.size());
+	next_chars.assign(is_word.size(), 0);
+	for (node = 0; node < is_word.size(); node++)
+	{
+		required_letters[node] = is_word[node] ? 0 : ALL_LETTERS;
+	}
+
+	for (const std::pair<uint64_t, uint32_t>& edge : sorted_edges)
+	{
+		node = (uint32_t)(edge.first >> 8);
+		next_chars[node] |= char_bit((char)(edge.first & 0xff));
+		if (is_word[node] == false)
+			required_letters[node] &= letter_bit((char)(edge.first & 0xff)) | required_letters[edge.second];
+	}
+}
+
 /***********************************************************************************************************************
 *                                                                                                                     *
 * FUNCTION: FindWord                                                                                                  *
@@ -432,15 +372,962 @@ return_code WordListSet::WordList::BuildWorldList(const char* file_name)
 * PARAMETERS: word (in) - word to search/find                                                                         *
 *                                                                                                                     *
 * RETURN: WORD_FOUND - word is found                                                                                  *
-*         PREFIX_FOUND - word not found (might be found as a prefix)                                                  *
+*         PREFIX_FOUND - word is found as a prefix of another word (e.g. "aband" as a prefix of "abandon")            *
+*         NOT_FOUND - word not found (also not found as a prefix)                                                     *
 *                                                                                                                     *
 * NOTES:                                                                                                              *
 *                                                                                                                     *
 ***********************************************************************************************************************/
 int WordListSet::WordList::FindWord(const char *word) const
 {
-	if (list.find(string(word)) != list.end())
-		return WORD_FOUND;
+	Node node;
+
+	assert(*word);
+
+	for (node = Root(); *word != '\0'; word++)
+	{
+		node = Step(node, *word);
+		if (node == NO_NODE)
+			return NOT_FOUND;
+	}
+
+	return IsWord(node) ? WORD_FOUND : PREFIX_FOUND;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: next_line                                                                                                 *
+*                                                                                                                     *
+* DESCRIPTION: take the next line of a word list file mapped to memory                                                *
+*                                                                                                                     *
+* PARAMETERS: pos (in/out) - start of the next line (moved past its line end)                                         *
+*             end (in) - end of the file                                                                              *
+*             line (out) - the line w/o its line end (LF or CR LF; the last line may have none)                       *
+*                                                                                                                     *
+* RETURN: true - a line was taken; false - end of file                                                                *
+*                                                                                                                     *
+* NOTES: line points into the file (no copy) - the line end is found by memchr (vectorized by the C library)         *
+*                                                                                                                     *
+***********************************************************************************************************************/
+static bool next_line(const char **pos, const char *end, std::string_view *line)
+{
+	const char *line_end;
+
+	if (*pos >= end)
+	{
+		return false;
+	}
+
+	line_end = (const char*)memchr(*pos, '\n', end - *pos);
+	if (line_end == NULL)
+	{
+		line_end = end;
+	}
+
+	*line = std::string_view(*pos, line_end - *pos);
+	if ((line->empty() == false) && (line->back() == '\r'))
+	{
+		line->remove_suffix(1);
+	}
+
+	*pos = (line_end < end) ? (line_end + 1) : end;
+	return true;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: read_words                                                                                                *
+*                                                                                                                     *
+* DESCRIPTION: read all words of a word list input file                                                               *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - word list file name                                                                    *
+*             file (out) - the file mapped to memory (words point into it - must stay open while they are used)       *
+*             words (out) - words read (in file order)                                                                *
+*                                                                                                                     *
+* RETURN:    RC_FILE_NOT_FOUND - file not found                                                                       *
+*            RC_EOF - no error (end of file)                                                                          *
+*                                                                                                                     *
+* NOTES: only words of characters 'a'..'z' are read - any other word (or empty line) is skipped                      *
+*                                                                                                                     *
+***********************************************************************************************************************/
+static return_code read_words(const char *file_name, FileMap& file, std::vector<std::string_view>& words)
+{
+	const char *pos, *end;
+	std::string_view word;
+
+	if (file.Open(file_name) != RC_NO_ERROR)
+	{
+		return RC_FILE_NOT_FOUND;
+	}
+
+	pos = file.Data();
+	end = file.Data() + file.Size();
+	words.reserve(std::count(pos, end, '\n') + 1);
+	while (next_line(&pos, end, &word))
+	{
+		if ((word.empty() == false) && (word.find_first_not_of("abcdefghijklmnopqrstuvwxyz") == std::string_view::npos))
+		{
+			words.push_back(word);
+		}
+	}
+
+	return RC_EOF;
+}
+
+/*
+ CONCEPT: word list as a flat array of character nodes
+
+ the same character tree as WordListTree, but all nodes are kept in one array and the children of a node are consecutive
+ entries in the array, so a node needs no ADJACENT/NEXT pointers: a 26 bit map of its children's characters and the index
+ of its first child are enough (the child of character ch is first_child + number of bits set in the map below ch's bit).
+
+ e.g. word list with the following words (. means IS_WORD bit is set; [n] is the array index of a node):
+ aa
+ aah
+ aal
+
+ [0]root {a}      first_child=1
+ [1]a    {a}      first_child=2
+ [2]a.   {h,l}    first_child=3
+ [3]h.   {}
+ [4]l.   {}
+ */
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: build_char_array                                                                                          *
+*                                                                                                                     *
+* DESCRIPTION: Build the flat character tree from a sorted list of words                                              *
+*                                                                                                                     *
+* PARAMETERS: words (in/out) - words to add (sorted and made unique in place)                                         *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*                                                                                                                     *
+* NOTES: the node array is allocated once - the number of nodes is the number of distinct prefixes of all words       *
+*        the required letters of a node are set once all its children are added                                       *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListArray::WordList::build_char_array(vector<std::string_view>& words)
+{
+	struct builder
+	{
+		vector<ArrayNode>& nodes;
+		vector<uint32_t>& required_letters;
+		const vector<std::string_view>& words;
+
+		/* add the children of node (all words in [begin, end) share its prefix of length depth) and recursively their children *
+		 * - returns the required letters of node                                                                               */
+		uint32_t add_children(uint32_t node, size_t begin, size_t end, size_t depth)
+		{
+			uint32_t first_child, letters = ALL_LETTERS;
+			size_t next;
+			char ch;
+
+			if ((begin < end) && (words[begin].length() == depth))
+			{
+				nodes[node].children |= IS_WORD_BIT;
+				begin++;
+			}
+
+			/* 1st pass: allocate all children of node as consecutive nodes */
+			first_child = (uint32_t)nodes.size();
+			nodes[node].first_child = first_child;
+			for (next = begin; next < end; )
+			{
+				ch = words[next][depth];
+				nodes[node].children |= 1u << (ch - 'a');
+				nodes.push_back(ArrayNode{ 0, 0 });
+				while ((next < end) && (words[next][depth] == ch))
+					next++;
+			}
+
+			/* 2nd pass: add each child's children */
+			while (begin < end)
+			{
+				ch = words[begin][depth];
+				for (next = begin; (next < end) && (words[next][depth] == ch); next++);
+				letters &= letter_bit(ch) | add_children(first_child++, begin, next, depth + 1);
+				begin = next;
+			}
+
+			return required_letters[node] = (nodes[node].children & IS_WORD_BIT) ? 0 : letters;
+		}
+	} build = { nodes, required_letters, words };
+
+	size_t i, lcp, no_of_nodes;
+
+	if (std::is_sorted(words.begin(), words.end()) == false)
+	{
+		std::sort(words.begin(), words.end());
+	}
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	/* number of nodes = root + one node per character not shared with the previous (sorted) word */
+	for (no_of_nodes = 1, i = 0; i < words.size(); i++)
+	{
+		lcp = 0;
+		if (i > 0)
+		{
+			while ((lcp < words[i].length()) && (lcp < words[i - 1].length()) && (words[i][lcp] == words[i - 1][lcp]))
+				lcp++;
+		}
+		no_of_nodes += words[i].length() - lcp;
+	}
+
+	nodes.clear();
+	nodes.reserve(no_of_nodes);
+	nodes.push_back(ArrayNode{ 0, 0 });
+	required_letters.assign(no_of_nodes, 0);
+	build.add_children(Root(), 0, words.size(), 0);
+
+	assert(nodes.size() == no_of_nodes);
+	no_of_words = words.size();
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BuildWorldList                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: Build flat character tree for word list from a word list input file                                    *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - word list file name                                                                    *
+*                                                                                                                     *
+* RETURN:    RC_FILE_NOT_FOUND - file not found                                                                       *
+*            RC_EOF - no error (end of file)                                                                          *
+*                                                                                                                     *
+* NOTES: only words of characters 'a'..'z' can be kept in the array - any other word is skipped (see read_words)      *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListArray::WordList::BuildWorldList(const char *file_name)
+{
+	FileMap file;
+	vector<std::string_view> words;
+	return_code ret_code;
+
+	ret_code = read_words(file_name, file, words);
+	if (ret_code != RC_EOF)
+	{
+		return ret_code;
+	}
+
+	return (build_char_array(words) == RC_NO_ERROR) ? RC_EOF : RC_NO_MEM;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BuildWorldList                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: Build flat character tree for word list from words in memory                                           *
+*                                                                                                                     *
+* PARAMETERS: words (in/out) - words to add (sorted and made unique in place; not needed after the call)              *
+*                                                                                                                     *
+* RETURN:    RC_EOF - no error (as for a word list file)                                                              *
+*                                                                                                                     *
+* NOTES: only words of characters 'a'..'z' are added - any other word (or empty word) is removed from words          *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListArray::WordList::BuildWorldList(vector<std::string_view>& words)
+{
+	words.erase(std::remove_if(words.begin(), words.end(), [](std::string_view word)
+	{
+		return word.empty() || (word.find_first_not_of("abcdefghijklmnopqrstuvwxyz") != std::string_view::npos);
+	}), words.end());
+
+	return (build_char_array(words) == RC_NO_ERROR) ? RC_EOF : RC_NO_MEM;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: FindWord                                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: find a word in a word list                                                                             *
+*                                                                                                                     *
+* PARAMETERS: word (in) - word to search/find                                                                         *
+*                                                                                                                     *
+* RETURN: WORD_FOUND - word is found                                                                                  *
+*         PREFIX_FOUND - word is found as a prefix of another word (e.g. "aband" as a prefix of "abandon")            *
+*         NOT_FOUND - word not found (also not found as a prefix)                                                     *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+int WordListArray::WordList::FindWord(const char *word) const
+{
+	Node node;
+
+	assert(*word);
+
+	for (node = Root(); *word != '\0'; word++)
+	{
+		node = Step(node, *word);
+		if (node == NO_NODE)
+			return NOT_FOUND;
+	}
+
+	return IsWord(node) ? WORD_FOUND : PREFIX_FOUND;
+}
+
+/*
+ CONCEPT: word list as a minimized character tree (DAWG - directed acyclic word graph)
+
+ the flat character tree of WordListArray repeats every common ending ("-ing", "-ed", "-s", "-ness") under each prefix
+ it follows. here two nodes with the same set of completions (same IS_WORD and same edges to the same nodes) are merged
+ into one node, so a node can have many parents and the tree becomes a graph. the node of a prefix still tells whether
+ the prefix is a word and which characters can follow it, so Step()/IsWord() answer exactly as a tree would.
+
+ e.g. word list with the following words (. means IS_WORD bit is set):
+ cats
+ dogs
+
+ root -c-> [1] -a-> [2] -t-> [3] -s-> [4].
+      -d-> [5] -o-> [6] -g-> [3]              ("cat" and "dog" have the same completions, so they share node [3])
+
+ the graph is built in one pass over the sorted words (Daciuk et al. incremental construction): once a word does not
+ share a prefix with the previous word anymore, the nodes of the previous word's remaining suffix can't change, so they
+ are merged with an identical registered node or registered themselves (bottom-up).
+ */
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: build_dawg                                                                                                *
+*                                                                                                                     *
+* DESCRIPTION: Build the minimized character graph from a list of words                                               *
+*                                                                                                                     *
+* PARAMETERS: words (in/out) - words to add (sorted and made unique in place)                                         *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*                                                                                                                     *
+* NOTES: the graph is built in temporary nodes and then flattened into node/edge arrays in breadth first order        *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListDawg::WordList::build_dawg(vector<std::string_view>& words)
+{
+	/* node of the graph under construction (edges are added in character order since words are sorted) */
+	struct BuildNode
+	{
+		bool is_word;
+		vector<std::pair<char, uint32_t> > edges;
+	};
+
+	vector<BuildNode> build_nodes(1); /* build_nodes[0] is the root */
+	vector<uint32_t> free_nodes;      /* merged nodes to be reused */
+	std::unordered_map<string, uint32_t> registry; /* node signature -> registered node */
+	vector<uint32_t> path(1, 0);      /* path[d] - node of the previous word's prefix of length d */
+	vector<uint32_t> new_index;
+	vector<uint32_t> edge_targets, edge_words; /* per edge: target and words_before (packed by pack_edges) */
+	const uint32_t NO_INDEX = UINT32_MAX;
+	string signature;
+	uint32_t node, parent, registered;
+	size_t i, d, lcp;
+
+	if (std::is_sorted(words.begin(), words.end()) == false)
+	{
+		std::sort(words.begin(), words.end());
+	}
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	for (i = 0; i <= words.size(); i++)
+	{
+		/* common prefix with the previous word (0 after the last word - minimize everything) */
+		lcp = 0;
+		if ((i > 0) && (i < words.size()))
+		{
+			while ((lcp < words[i].length()) && (lcp < words[i - 1].length()) && (words[i][lcp] == words[i - 1][lcp]))
+				lcp++;
+		}
+
+		/* merge or register the previous word's nodes below the common prefix (bottom-up) */
+		for (d = path.size() - 1; d > lcp; d--)
+		{
+			node = path[d];
+			parent = path[d - 1];
+
+			signature.assign(1, build_nodes[node].is_word ? '.' : '-');
+			for (const std::pair<char, uint32_t>& edge : build_nodes[node].edges)
+			{
+				signature.push_back(edge.first);
+				signature.append((const char*)&edge.second, sizeof(edge.second));
+			}
+
+			std::pair<std::unordered_map<string, uint32_t>::iterator, bool> reg = registry.try_emplace(signature, node);
+			if (reg.second == false)
+			{
+				registered = reg.first->second;
+				build_nodes[parent].edges.back().second = registered;
+				build_nodes[node].edges.clear();
+				free_nodes.push_back(node);
+			}
+			path.pop_back();
+		}
+
+		if (i == words.size())
+			break;
+
+		/* add the word's suffix after the common prefix as new nodes */
+		for (d = lcp; d < words[i].length(); d++)
+		{
+			if (free_nodes.empty() == false)
+			{
+				node = free_nodes.back();
+				free_nodes.pop_back();
+			}
+			else
+			{
+				node = (uint32_t)build_nodes.size();
+				build_nodes.push_back(BuildNode());
+			}
+			build_nodes[node].is_word = false;
+			build_nodes[path.back()].edges.push_back(std::make_pair(words[i][d], node));
+			path.push_back(node);
+		}
+		build_nodes[path.back()].is_word = true;
+	}
+
+	/* flatten the graph reachable from the root in breadth first order */
+	vector<uint32_t> order(1, 0);
+	new_index.assign(build_nodes.size(), NO_INDEX);
+	new_index[0] = 0;
+
+	image.Close();
+	built_nodes.clear();
+	built_nodes.reserve(registry.size() + 1);
+	edge_targets.reserve(registry.size() * 2);
+	for (i = 0; i < order.size(); i++)
+	{
+		const BuildNode& build_node = build_nodes[order[i]];
+		DawgNode dawg_node = { build_node.is_word ? (uint32_t)IS_WORD_BIT : 0, (uint32_t)edge_targets.size() };
+
+		for (const std::pair<char, uint32_t>& edge : build_node.edges)
+		{
+			if (new_index[edge.second] == NO_INDEX)
+			{
+				new_index[edge.second] = (uint32_t)order.size();
+				order.push_back(edge.second);
+			}
+			dawg_node.children |= 1u << (edge.first - 'a');
+			edge_targets.push_back(new_index[edge.second]);
+		}
+		built_nodes.push_back(dawg_node);
+	}
+	built_nodes.shrink_to_fit();
+	edge_words.assign(edge_targets.size(), 0);
+	built_required_letters.assign(built_nodes.size(), 0);
+
+	/* number the words: each edge counts the words that end at its node or go through the node's lower edges *
+	 * (and set the required letters of each node as its words are counted)                                    */
+	struct word_counter
+	{
+		vector<DawgNode>& nodes;
+		const vector<uint32_t>& targets;
+		vector<uint32_t>& words_before;
+		vector<uint32_t>& required_letters;
+		vector<uint32_t> words_from; /* number of words from a node on (NO_INDEX - not counted yet) */
+
+		uint32_t count(uint32_t node)
+		{
+			uint32_t words, letters, children, e;
+
+			if (words_from[node] != NO_INDEX)
+				return words_from[node];
+
+			words = (nodes[node].children & IS_WORD_BIT) ? 1 : 0;
+			letters = ALL_LETTERS;
+			children = nodes[node].children & ~(uint32_t)IS_WORD_BIT;
+			for (e = nodes[node].first_edge; children != 0; e++, children &= children - 1)
+			{
+				words_before[e] = words;
+				words += count(targets[e]);
+				letters &= (children & (0 - children)) | required_letters[targets[e]]; /* lowest set bit - the edge's letter */
+			}
+
+			required_letters[node] = (nodes[node].children & IS_WORD_BIT) ? 0 : letters;
+			return words_from[node] = words;
+		}
+	} counter = { built_nodes, edge_targets, edge_words, built_required_letters, vector<uint32_t>(built_nodes.size(), NO_INDEX) };
+	counter.count(Root());
+
+	if (pack_edges(edge_targets, edge_words) != RC_NO_ERROR)
+	{
+		return RC_NO_MEM;
+	}
+
+	nodes = built_nodes.data();
+	edges = built_edges.data();
+	required_letters = built_required_letters.data();
+	overflow_words = built_overflow_words.data();
+	no_of_nodes = built_nodes.size();
+	no_of_edges = built_edges.size();
+	no_of_overflow_words = built_overflow_words.size();
+	no_of_words = words.size();
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: pack_edges                                                                                                *
+*                                                                                                                     *
+* DESCRIPTION: pack every edge's target and words_before into one 32 bit DawgEdge (built_edges)                       *
+*                                                                                                                     *
+* PARAMETERS: targets (in) - target node of every edge                                                                *
+*             words_before (in) - words_before of every edge                                                          *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_NO_MEM - too many nodes (or too many large words_before) to pack                                      *
+*                                                                                                                     *
+* NOTES: the target takes the bits a node index needs (17 for 77k nodes), words_before the rest; the words_before     *
+*        that don't fit (near the root, e.g. 23 edges of 264k words) go to built_overflow_words, each edge given one  *
+*        of the top codes (overflow_base and up) as an index - as many top codes as there are such edges              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListDawg::WordList::pack_edges(const vector<uint32_t>& targets, const vector<uint32_t>& words_before)
+{
+	uint64_t codes, no_of_top_codes, no_of_overflows;
+	size_t e;
+
+	for (target_bits = 1; ((uint64_t)1 << target_bits) < built_nodes.size(); target_bits++);
+	if (target_bits >= 32)
+	{
+		return RC_NO_MEM;
+	}
+	target_mask = (uint32_t)(((uint64_t)1 << target_bits) - 1);
+	codes = (uint64_t)1 << (32 - target_bits);
+
+	/* reserve the top codes for the words_before that don't fit below them (more reserved codes - more such edges) */
+	no_of_top_codes = 0;
+	while (true)
+	{
+		no_of_overflows = (uint64_t)std::count_if(words_before.begin(), words_before.end(), [&](uint32_t words) { return words >= codes - no_of_top_codes; });
+		if (no_of_overflows <= no_of_top_codes)
+			break;
+		no_of_top_codes = no_of_overflows;
+		if (no_of_top_codes >= codes)
+		{
+			return RC_NO_MEM;
+		}
+	}
+	overflow_base = (uint32_t)(codes - no_of_top_codes);
+
+	built_edges.assign(targets.size(), 0);
+	built_overflow_words.clear();
+	for (e = 0; e < targets.size(); e++)
+	{
+		if (words_before[e] < overflow_base)
+		{
+			built_edges[e] = (words_before[e] << target_bits) | targets[e];
+			continue;
+		}
+
+		built_edges[e] = ((overflow_base + (uint32_t)built_overflow_words.size()) << target_bits) | targets[e];
+		built_overflow_words.push_back(words_before[e]);
+	}
+	built_overflow_words.shrink_to_fit();
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: BuildWorldList                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: Build minimized character graph for word list from a word list input file                              *
+*              (or load it from a binary image file made by SaveImage)                                                *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - word list file name (or image file name)                                               *
+*                                                                                                                     *
+* RETURN:    RC_FILE_NOT_FOUND - file not found                                                                       *
+*            RC_BAD_IMAGE - image file of another version or corrupted                                                *
+*            RC_EOF - no error (end of file)                                                                          *
+*                                                                                                                     *
+* NOTES: only words of characters 'a'..'z' can be kept in the graph - any other word is skipped (see read_words)      *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListDawg::WordList::BuildWorldList(const char *file_name)
+{
+	FileMap file;
+	vector<std::string_view> words;
+	return_code ret_code;
+
+	if (IsImage(file_name))
+	{
+		ret_code = LoadImage(file_name);
+		return (ret_code == RC_NO_ERROR) ? RC_EOF : ret_code;
+	}
+
+	ret_code = read_words(file_name, file, words);
+	if (ret_code != RC_EOF)
+	{
+		return ret_code;
+	}
+
+	return (build_dawg(words) == RC_NO_ERROR) ? RC_EOF : RC_NO_MEM;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: FindWord                                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: find a word in a word list                                                                             *
+*                                                                                                                     *
+* PARAMETERS: word (in) - word to search/find                                                                         *
+*                                                                                                                     *
+* RETURN: WORD_FOUND - word is found                                                                                  *
+*         PREFIX_FOUND - word is found as a prefix of another word (e.g. "aband" as a prefix of "abandon")            *
+*         NOT_FOUND - word not found (also not found as a prefix)                                                     *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+int WordListDawg::WordList::FindWord(const char *word) const
+{
+	Node node;
+
+	assert(*word);
+
+	for (node = Root(); *word != '\0'; word++)
+	{
+		node = Step(node, *word);
+		if (node == NO_NODE)
+			return NOT_FOUND;
+	}
+
+	return IsWord(node) ? WORD_FOUND : PREFIX_FOUND;
+}
+
+/*
+ CONCEPT: dawg binary image file
+
+ the flattened dawg has no pointers (edges hold node indices), so it is written to a file as is and read back by mapping
+ the file to memory - Step() then works directly on the mapped file.
+
+ +----------------------------------+
+ | ImageHeader                      |  magic "WSDAWG", version, byte order, counts, edge packing, checksum of everything
+ |                                  |  after the header
+ +----------------------------------+
+ | DawgNode  x no_of_nodes          |
+ +----------------------------------+
+ | DawgEdge  x no_of_edges          |  packed: target and words_before in 32 bits (see DawgEdge)
+ +----------------------------------+
+ | uint32_t  x no_of_nodes          |  required letters of every node (see RequiredLetters)
+ +----------------------------------+
+ | uint32_t  x no_of_overflow_words |  words_before of the edges whose count doesn't fit in their DawgEdge
+ +----------------------------------+
+
+ an image of another version (or written on a machine of another byte order) or with a wrong checksum is rejected.
+ */
+
+static const char IMAGE_MAGIC[8] = { 'W', 'S', 'D', 'A', 'W', 'G', '\0', '\0' };
+static const uint32_t IMAGE_VERSION = 4;
+static const uint32_t IMAGE_BYTE_ORDER = 0x01020304;
+static const uint64_t IMAGE_CHECKSUM_INIT = 0xcbf29ce484222325ULL;
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: image_checksum                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: checksum of image data (FNV-1a, 64 bit)                                                                *
+*                                                                                                                     *
+* PARAMETERS: checksum (in) - checksum of the preceding data (IMAGE_CHECKSUM_INIT at the start of the data)           *
+*             data (in) - image data (after the header)                                                               *
+*             size (in) - data size in bytes                                                                          *
+*                                                                                                                     *
+* RETURN: checksum                                                                                                    *
+*                                                                                                                     *
+* NOTES: data can be given in parts, e.g. nodes and then edges                                                        *
+*                                                                                                                     *
+***********************************************************************************************************************/
+uint64_t WordListDawg::WordList::image_checksum(uint64_t checksum, const char *data, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+	{
+		checksum = (checksum ^ (unsigned char)data[i]) * 0x100000001b3ULL;
+	}
+
+	return checksum;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: check_image                                                                                               *
+*                                                                                                                     *
+* DESCRIPTION: check that a mapped image's nodes and edges are consistent (Step never reads outside them)             *
+*                                                                                                                     *
+* PARAMETERS: header (in) - image header (counts and edge packing)                                                    *
+*             nodes, edges, overflow_words (in) - image nodes, edges and overflow words                               *
+*                                                                                                                     *
+* RETURN: true - consistent; false - otherwise                                                                        *
+*                                                                                                                     *
+* NOTES: every node's edges must be within the edges, every edge's target a node and every edge's overflow index      *
+*        within the overflow words; the words are then counted from the root (each node once, depth first on an       *
+*        explicit stack): the graph must have no cycle, every edge's words_before must be the count of the words      *
+*        before it and the root must count no_of_words - so every word id (the sum of words_before along a word's     *
+*        path) is below no_of_words. O(nodes + edges)                                                                 *
+*                                                                                                                     *
+***********************************************************************************************************************/
+bool WordListDawg::WordList::check_image(const ImageHeader& header, const DawgNode *nodes, const DawgEdge *edges, const uint32_t *overflow_words)
+{
+	enum { NOT_COUNTED, COUNTING, COUNTED };
+
+	/* a node being counted: its edges left (children bits), its next edge and its words counted so far */
+	struct count_frame
+	{
+		uint32_t node;
+		uint32_t children;
+		uint32_t edge;
+		uint64_t words;
+	};
+
+	size_t no_of_nodes = (size_t)header.no_of_nodes, no_of_edges = (size_t)header.no_of_edges;
+	uint32_t target_mask = (uint32_t)(((uint64_t)1 << header.target_bits) - 1);
+	vector<uint8_t> state(no_of_nodes, NOT_COUNTED);
+	vector<uint32_t> words_from(no_of_nodes, 0);
+	vector<count_frame> stack;
+	uint32_t node, target, words_before;
+	size_t i;
+
+	for (i = 0; i < no_of_nodes; i++)
+	{
+		if (((nodes[i].children & ~(ALL_LETTERS | (uint32_t)IS_WORD_BIT)) != 0) ||
+			((uint64_t)nodes[i].first_edge + bit_count(nodes[i].children & ALL_LETTERS) > no_of_edges))
+			return false;
+	}
+	for (i = 0; i < no_of_edges; i++)
+	{
+		words_before = edges[i] >> header.target_bits;
+		if (((edges[i] & target_mask) >= no_of_nodes) ||
+			((words_before >= header.overflow_base) && (words_before - header.overflow_base >= header.no_of_overflow_words)))
+			return false;
+	}
+
+	state[0] = COUNTING;
+	stack.push_back(count_frame{ 0, nodes[0].children & ALL_LETTERS, nodes[0].first_edge, (nodes[0].children & IS_WORD_BIT) ? 1u : 0u });
+	while (stack.empty() == false)
+	{
+		count_frame& frame = stack.back();
+
+		if (frame.children == 0)
+		{
+			/* all edges counted - add the node's words to its parent's */
+			if (frame.words > UINT32_MAX)
+				return false;
+			node = frame.node;
+			words_from[node] = (uint32_t)frame.words;
+			state[node] = COUNTED;
+			stack.pop_back();
+			if (stack.empty() == false)
+			{
+				stack.back().words += words_from[node];
+				stack.back().children &= stack.back().children - 1;
+				stack.back().edge++;
+			}
+			continue;
+		}
+
+		words_before = edges[frame.edge] >> header.target_bits;
+		if (words_before >= header.overflow_base)
+			words_before = overflow_words[words_before - header.overflow_base];
+		if (words_before != frame.words)
+			return false;
+
+		target = edges[frame.edge] & target_mask;
+		if (state[target] == COUNTING)
+			return false; /* a cycle */
+
+		if (state[target] == COUNTED)
+		{
+			frame.words += words_from[target];
+			frame.children &= frame.children - 1;
+			frame.edge++;
+			continue;
+		}
+
+		state[target] = COUNTING;
+		stack.push_back(count_frame{ target, nodes[target].children & ALL_LETTERS, nodes[target].first_edge, (nodes[target].children & IS_WORD_BIT) ? 1u : 0u });
+	}
+
+	return words_from[0] == header.no_of_words;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: SaveImage                                                                                                 *
+*                                                                                                                     *
+* DESCRIPTION: write the dawg to a binary image file                                                                  *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - image file name                                                                        *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_FILE_WRITE_ERROR - file can't be created/written                                                      *
+*                                                                                                                     *
+* NOTES: must be called only after BuildWorldList                                                                     *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListDawg::WordList::SaveImage(const char *file_name) const
+{
+	ImageHeader header;
+	uint64_t checksum;
+	std::ofstream file;
+
+	checksum = image_checksum(IMAGE_CHECKSUM_INIT, (const char*)nodes, no_of_nodes * sizeof(DawgNode));
+	checksum = image_checksum(checksum, (const char*)edges, no_of_edges * sizeof(DawgEdge));
+	checksum = image_checksum(checksum, (const char*)required_letters, no_of_nodes * sizeof(uint32_t));
+	checksum = image_checksum(checksum, (const char*)overflow_words, no_of_overflow_words * sizeof(uint32_t));
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+	header.version = IMAGE_VERSION;
+	header.byte_order = IMAGE_BYTE_ORDER;
+	header.no_of_words = no_of_words;
+	header.no_of_nodes = no_of_nodes;
+	header.no_of_edges = no_of_edges;
+	header.target_bits = target_bits;
+	header.overflow_base = overflow_base;
+	header.no_of_overflow_words = no_of_overflow_words;
+	header.checksum = checksum;
+
+	file.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cerr << "Can't create file: " << file_name << std::endl;
+		return RC_FILE_WRITE_ERROR;
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)nodes, no_of_nodes * sizeof(DawgNode));
+	file.write((const char*)edges, no_of_edges * sizeof(DawgEdge));
+	file.write((const char*)required_letters, no_of_nodes * sizeof(uint32_t));
+	file.write((const char*)overflow_words, no_of_overflow_words * sizeof(uint32_t));
+	file.close();
+
+	if (file.fail())
+	{
+		std::cerr << "Can't write file: " << file_name << std::endl;
+		return RC_FILE_WRITE_ERROR;
+	}
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: LoadImage                                                                                                 *
+*                                                                                                                     *
+* DESCRIPTION: map a binary image file (made by SaveImage) and use it as the dawg                                     *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - image file name                                                                        *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_FILE_NOT_FOUND - file not found                                                                       *
+*            RC_BAD_IMAGE - not an image file, image file of another version or corrupted                             *
+*                                                                                                                     *
+* NOTES: nothing is parsed - nodes/edges/required letters point into the mapped file; the nodes and edges are only    *
+*        checked once to be consistent (see check_image)                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code WordListDawg::WordList::LoadImage(const char *file_name)
+{
+	ImageHeader header;
+	const char *data;
+	uint64_t checksum;
+	return_code ret_code;
+
+	ret_code = image.Open(file_name);
+	if (ret_code != RC_NO_ERROR)
+	{
+		return ret_code;
+	}
+
+	if (image.Size() < sizeof(header))
+	{
+		std::cerr << "Bad image file: " << file_name << std::endl;
+		image.Close();
+		return RC_BAD_IMAGE;
+	}
+
+	memcpy(&header, image.Data(), sizeof(header));
+	data = image.Data() + sizeof(header);
+	if ((memcmp(header.magic, IMAGE_MAGIC, sizeof(header.magic)) != 0) || (header.version != IMAGE_VERSION) ||
+		(header.byte_order != IMAGE_BYTE_ORDER) || (header.no_of_nodes == 0) ||
+		(header.no_of_nodes > UINT32_MAX) || (header.no_of_edges > UINT32_MAX) || (header.no_of_overflow_words > UINT32_MAX) ||
+		(header.target_bits == 0) || (header.target_bits >= 32) || (header.overflow_base > ((uint64_t)1 << (32 - header.target_bits))) ||
+		(image.Size() != sizeof(header) + header.no_of_nodes * (sizeof(DawgNode) + sizeof(uint32_t)) + header.no_of_edges * sizeof(DawgEdge) +
+			header.no_of_overflow_words * sizeof(uint32_t)))
+	{
+		std::cerr << "Bad image file (wrong version or size): " << file_name << std::endl;
+		image.Close();
+		return RC_BAD_IMAGE;
+	}
+
+	checksum = image_checksum(IMAGE_CHECKSUM_INIT, data, image.Size() - sizeof(header));
+	if (checksum != header.checksum)
+	{
+		std::cerr << "Bad image file (wrong checksum): " << file_name << std::endl;
+		image.Close();
+		return RC_BAD_IMAGE;
+	}
+
+	if (check_image(header, (const DawgNode*)data, (const DawgEdge*)(data + header.no_of_nodes * sizeof(DawgNode)),
+		(const uint32_t*)(data + header.no_of_nodes * (sizeof(DawgNode) + sizeof(uint32_t)) + header.no_of_edges * sizeof(DawgEdge))) == false)
+	{
+		std::cerr << "Bad image file (inconsistent nodes or edges): " << file_name << std::endl;
+		image.Close();
+		return RC_BAD_IMAGE;
+	}
+
+	built_nodes.clear();
+	built_nodes.shrink_to_fit();
+	built_edges.clear();
+	built_edges.shrink_to_fit();
+	built_required_letters.clear();
+	built_required_letters.shrink_to_fit();
+	built_overflow_words.clear();
+	built_overflow_words.shrink_to_fit();
+
+	nodes = (const DawgNode*)data;
+	edges = (const DawgEdge*)(data + header.no_of_nodes * sizeof(DawgNode));
+	required_letters = (const uint32_t*)(data + header.no_of_nodes * sizeof(DawgNode) + header.no_of_edges * sizeof(DawgEdge));
+	overflow_words = (const uint32_t*)(data + header.no_of_nodes * (sizeof(DawgNode) + sizeof(uint32_t)) + header.no_of_edges * sizeof(DawgEdge));
+	no_of_nodes = (size_t)header.no_of_nodes;
+	no_of_edges = (size_t)header.no_of_edges;
+	no_of_overflow_words = (size_t)header.no_of_overflow_words;
+	target_bits = header.target_bits;
+	target_mask = (uint32_t)(((uint64_t)1 << header.target_bits) - 1);
+	overflow_base = header.overflow_base;
+	no_of_words = (size_t)header.no_of_words;
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: IsImage                                                                                                   *
+*                                                                                                                     *
+* DESCRIPTION: check whether a file is a binary image file (by its magic only - not validated)                        *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - file name                                                                              *
+*                                                                                                                     *
+* RETURN: true - file starts with the image magic                                                                     *
+*         false - otherwise (or file not found)                                                                       *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+bool WordListDawg::WordList::IsImage(const char *file_name)
+{
+	char magic[sizeof(IMAGE_MAGIC)];
+	ifstream file;
+
+	file.open(file_name, std::ios::in | std::ios::binary);
+	if (file.is_open() == false)
+	{
+		return false;
+	}
+
+	file.read(magic, sizeof(magic));
 
-	return PREFIX_FOUND;
+	return (file.gcount() == sizeof(magic)) && (memcmp(magic, IMAGE_MAGIC, sizeof(magic)) == 0);
 }
@@ -4,11 +4,25 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include "gen_defs.h"
+#include "file_map.h"
 
 using std::ifstream;
 using std::string;
 
+/* letter set: bit 0 - 'a' .. bit 25 - 'z' (a character that is not 'a'..'z' has no bit) */
+const uint32_t ALL_LETTERS = (1u << 26) - 1;
+inline uint32_t letter_bit(char ch) { return ((ch >= 'a') && (ch <= 'z')) ? (1u << (ch - 'a')) : 0; }
+
+/* character set: a letter set plus OTHER_CHAR_BIT for every character that is not 'a'..'z' (see NextChars) */
+const uint32_t OTHER_CHAR_BIT = 1u << 26;
+inline uint32_t char_bit(char ch) { return ((ch >= 'a') && (ch <= 'z')) ? (1u << (ch - 'a')) : OTHER_CHAR_BIT; }
+
 namespace WordListTree 
 {
 	/* word list class */
@@ -16,65 +30,374 @@ namespace WordListTree
 	{
 	private:
 
-		/* character node struct */
+		/* character node struct (linked to other nodes by node index - 0 is the root, so it means "no node" in a link) */
 		class CharNode
 		{
 		public:
 			char ch;
 			bool is_word;
+			uint32_t word_id; /* 1, 2, ... in the order words are read (0 - no word ends at the node) */
+			uint32_t required_letters; /* see RequiredLetters */
+			uint32_t next_chars; /* see NextChars */
 
-			CharNode *adjacent;
-			CharNode *next;
-			CharNode(char _ch, bool _is_word) : ch(_ch), is_word(_is_word) { adjacent = next = NULL; }
+			uint32_t adjacent;
+			uint32_t next;
 		};
 
-		/* word list character tree */
-		CharNode *char_tree;
+		/* character nodes are allocated from slabs of SLAB_SIZE nodes (node index = slab << SLAB_BITS | offset) - *
+		 * nodes never move, and the whole tree is freed by freeing its slabs                                      */
+		enum { SLAB_BITS = 16, SLAB_SIZE = 1 << SLAB_BITS, NO_INDEX = 0, ROOT_INDEX = 0 };
+		std::vector<std::unique_ptr<CharNode[]> > slabs;
+		uint32_t no_of_slab_nodes; /* nodes taken from slabs (including the root) */
+
+		CharNode *char_node(uint32_t index) const { return &slabs[index >> SLAB_BITS][index & (SLAB_SIZE - 1)]; }
+
+		/* last word id given */
+		uint32_t no_of_word_ids;
 
 		/* for statistics */
 		size_t no_of_words;
 		size_t allocated_nodes;
-		size_t freed_nodes;
 
-		return_code add_word_to_char_tree(const string& word);
-		int find_word(CharNode *search_tree, const char *word) const;
-		size_t free_char_tree(CharNode *char_tree);
+		uint32_t alloc_char_node(char ch);
+		return_code add_word_to_char_tree(std::string_view word);
+		uint32_t set_required_letters(uint32_t index);
 
 	public:
 
 		enum { NOT_FOUND, WORD_FOUND, PREFIX_FOUND };
 
+		/* cursor to a prefix in the word list (NO_NODE - no word starts with that prefix) */
+		typedef const CharNode *Node;
+		static constexpr Node NO_NODE = NULL;
+
 		WordList();
 		~WordList();
+		WordList(const WordList&) = delete;
+		WordList& operator=(const WordList&) = delete;
 		return_code BuildWorldList(const char *file_name);
 		int FindWord(const char *word) const;
+
+		/* cursor API: Root() is the empty prefix, Step() appends one character to the prefix of node */
+		Node Root() const { return char_node(ROOT_INDEX); }
+		Node Step(Node node, char ch) const
+		{
+			uint32_t search;
+
+			/* ADJACENT list is kept sorted by character value */
+			for (search = node->next; (search != NO_INDEX) && (char_node(search)->ch < ch); search = char_node(search)->adjacent);
+
+			return ((search != NO_INDEX) && (char_node(search)->ch == ch)) ? char_node(search) : NO_NODE;
+		}
+		bool IsWord(Node node) const { return node->is_word; }
+
+		/* letters that every word starting with the prefix of node has after the prefix (0 if the prefix is a word) - *
+		 * the search skips a prefix whose completions all need a letter the grid does not have                      */
+		uint32_t RequiredLetters(Node node) const { return node->required_letters; }
+
+		/* characters that some word starting with the prefix of node has right after the prefix (see char_bit) - *
+		 * the search skips a cell none of whose adjacent cells' characters is one of them                       */
+		uint32_t NextChars(Node node) const { return node->next_chars; }
+
+		/* word id: a distinct number in 0..GetNoOfWordIds()-1 for every word (valid only if IsWord(node)) */
+		uint32_t WordId(Node node) const { return node->word_id; }
+		size_t GetNoOfWordIds() const { return (size_t)no_of_word_ids + 1; }
+
+		/* statistics */
+		size_t GetNoOfWords() const { return no_of_words; }
+		size_t GetNoOfNodes() const { return allocated_nodes; }
+		size_t GetMemUsage() const { return slabs.size() * SLAB_SIZE * sizeof(CharNode); }
 	};
 
 }
 
-#include <unordered_set>
-#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace WordListSet
 {
-	using std::unordered_set;
+	using std::unordered_map;
+	using std::vector;
 
+	/* word list class - prefixes are numbered nodes, linked by a hash of (node, character) edges */
 	class WordList
 	{
 	private:
-		unordered_set<string> list;
+		/* edge key: (node << 8) | character -> next node */
+		unordered_map<uint64_t, uint32_t> edges;
+
+		/* per node: is the node's prefix a whole word */
+		vector<bool> is_word;
+
+		/* per node: see RequiredLetters and NextChars */
+		vector<uint32_t> required_letters;
+		vector<uint32_t> next_chars;
 
 		/* for statistics */
 		size_t no_of_words;
 
+		static uint64_t edge_key(uint32_t node, char ch) { return ((uint64_t)node << 8) | (unsigned char)ch; }
+		void add_word(std::string_view word);
+		void set_required_letters();
+
+	public:
+
+		enum { NOT_FOUND, WORD_FOUND, PREFIX_FOUND };
+
+		/* cursor to a prefix in the word list (NO_NODE - no word starts with that prefix) */
+		typedef uint32_t Node;
+		static constexpr Node NO_NODE = UINT32_MAX;
+
+		WordList() : is_word(1, false), required_letters(1, ALL_LETTERS), next_chars(1, 0), no_of_words(0) {}
+		~WordList() {}
+		return_code BuildWorldList(const char *file_name);
+		int FindWord(const char *word) const;
+
+		/* cursor API: Root() is the empty prefix, Step() appends one character to the prefix of node */
+		Node Root() const { return 0; }
+		Node Step(Node node, char ch) const
+		{
+			unordered_map<uint64_t, uint32_t>::const_iterator edge = edges.find(edge_key(node, ch));
+
+			return (edge != edges.end()) ? edge->second : NO_NODE;
+		}
+		bool IsWord(Node node) const { return is_word[node]; }
+
+		/* letters that every word starting with the prefix of node has after the prefix (0 if the prefix is a word) */
+		uint32_t RequiredLetters(Node node) const { return required_letters[node]; }
+
+		/* characters that some word starting with the prefix of node has right after the prefix (see char_bit) */
+		uint32_t NextChars(Node node) const { return next_chars[node]; }
+
+		/* word id: a distinct number in 0..GetNoOfWordIds()-1 for every word (valid only if IsWord(node)) */
+		uint32_t WordId(Node node) const { return node; }
+		size_t GetNoOfWordIds() const { return is_word.size(); }
+
+		/* statistics (memory usage is an estimate of the hash table's nodes and buckets) */
+		size_t GetNoOfWords() const { return no_of_words; }
+		size_t GetNoOfNodes() const { return is_word.size(); }
+		size_t GetMemUsage() const { return edges.size() * (sizeof(std::pair<const uint64_t, uint32_t>) + sizeof(void*)) + edges.bucket_count() * sizeof(void*) + is_word.capacity() / 8 + (required_letters.capacity() + next_chars.capacity()) * sizeof(uint32_t); }
+	};
+}
+
+namespace WordListArray
+{
+	using std::vector;
+
+	/* number of set bits in a children bitmap */
+	inline uint32_t bit_count(uint32_t bits)
+	{
+#ifdef _MSC_VER
+		return __popcnt(bits);
+#else
+		return __builtin_popcount(bits);
+#endif
+	}
+
+	/* word list class - flat character tree, all nodes in one array, the children of a node are consecutive array entries */
+	class WordList
+	{
+	private:
+		enum { NO_OF_CHARS = 26, IS_WORD_BIT = 0x80000000 };
+
+		/* array node: bits 0..25 - which of 'a'..'z' have a child node; IS_WORD_BIT - the node's prefix is a whole word *
+		 *             first_child - index of the child of the lowest set bit (child of the n-th set bit is first_child + n) */
+		struct ArrayNode
+		{
+			uint32_t children;
+			uint32_t first_child;
+		};
+
+		/* character tree nodes (nodes[0] is the root) */
+		vector<ArrayNode> nodes;
+
+		/* per node: see RequiredLetters (apart from nodes - only read for a prefix the grid has) */
+		vector<uint32_t> required_letters;
+
+		/* for statistics */
+		size_t no_of_words;
+
+		return_code build_char_array(vector<std::string_view>& words);
+
 	public:
 
 		enum { NOT_FOUND, WORD_FOUND, PREFIX_FOUND };
 
+		/* cursor to a prefix in the word list (NO_NODE - no word starts with that prefix) */
+		typedef uint32_t Node;
+		static constexpr Node NO_NODE = UINT32_MAX;
+
 		WordList() : no_of_words(0) {}
 		~WordList() {}
 		return_code BuildWorldList(const char *file_name);
+		return_code BuildWorldList(vector<std::string_view>& words);
+		int FindWord(const char *word) const;
+
+		/* cursor API: Root() is the empty prefix, Step() appends one character to the prefix of node */
+		Node Root() const { return 0; }
+		Node Step(Node node, char ch) const
+		{
+			uint32_t c = (uint32_t)(ch - 'a');
+			uint32_t children = nodes[node].children;
+			uint32_t bit = 1u << (c & 31);
+
+			if ((c >= NO_OF_CHARS) || ((children & bit) == 0))
+				return NO_NODE;
+
+			return nodes[node].first_child + bit_count(children & (bit - 1));
+		}
+		bool IsWord(Node node) const { return (nodes[node].children & IS_WORD_BIT) != 0; }
+
+		/* letters that every word starting with the prefix of node has after the prefix (0 if the prefix is a word) */
+		uint32_t RequiredLetters(Node node) const { return required_letters[node]; }
+
+		/* characters that some word starting with the prefix of node has right after the prefix - the children bitmap */
+		uint32_t NextChars(Node node) const { return nodes[node].children & ALL_LETTERS; }
+
+		/* word id: a distinct number in 0..GetNoOfWordIds()-1 for every word (valid only if IsWord(node)) */
+		uint32_t WordId(Node node) const { return node; }
+		size_t GetNoOfWordIds() const { return nodes.size(); }
+
+		/* statistics */
+		size_t GetNoOfWords() const { return no_of_words; }
+		size_t GetNoOfNodes() const { return nodes.size(); }
+		size_t GetMemUsage() const { return nodes.capacity() * sizeof(ArrayNode) + required_letters.capacity() * sizeof(uint32_t); }
+	};
+}
+
+namespace WordListDawg
+{
+	using std::vector;
+	using WordListArray::bit_count;
+
+	/* word list class - minimized character tree (DAWG): prefixes with the same set of completions share one node */
+	class WordList
+	{
+	private:
+		enum { NO_OF_CHARS = 26, IS_WORD_BIT = 0x80000000 };
+
+		/* dawg node: bits 0..25 - which of 'a'..'z' have an edge; IS_WORD_BIT - a word may end at the node *
+		 *            first_edge - index in edges of the edge of the lowest set bit                            */
+		struct DawgNode
+		{
+			uint32_t children;
+			uint32_t first_edge;
+		};
+
+		/* dawg edge (packed): bits 0..target_bits-1 - target: node index                                            *
+		 *                    bits target_bits..31 - words_before: number of words that end at the edge's node or go *
+		 *                    through a lower edge of it (adds up along a word's path to the word's index in sorted  *
+		 *                    order); a words_before of overflow_base or more is an index (+ overflow_base) in       *
+		 *                    overflow_words - for the few edges (near the root) whose count doesn't fit             */
+		typedef uint32_t DawgEdge;
+
+		/* binary image file header (followed by no_of_nodes DawgNode, no_of_edges DawgEdge, no_of_nodes required *
+		 * letters and no_of_overflow_words overflow words)                                                       */
+		struct ImageHeader
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t byte_order;
+			uint64_t no_of_words;
+			uint64_t no_of_nodes;
+			uint64_t no_of_edges;
+			uint32_t target_bits;
+			uint32_t overflow_base;
+			uint64_t no_of_overflow_words;
+			uint64_t checksum;
+		};
+
+		/* dawg nodes (nodes[0] is the root) and edges (the edges of a node are consecutive and sorted by character)  *
+		 * - point either into built_nodes/built_edges or into a memory mapped image file                               */
+		const DawgNode *nodes;
+		const DawgEdge *edges;
+		const uint32_t *required_letters; /* per node: see RequiredLetters (merged nodes have the same completions) */
+		const uint32_t *overflow_words;   /* words_before of the edges whose count doesn't fit (see DawgEdge) */
+		size_t no_of_nodes;
+		size_t no_of_edges;
+		size_t no_of_overflow_words;
+
+		/* edge packing (see DawgEdge): target_mask - the target's bits */
+		uint32_t target_bits;
+		uint32_t target_mask;
+		uint32_t overflow_base;
+
+		/* storage of a dawg built from a word list file */
+		vector<DawgNode> built_nodes;
+		vector<DawgEdge> built_edges;
+		vector<uint32_t> built_required_letters;
+		vector<uint32_t> built_overflow_words;
+
+		/* storage of a dawg loaded from an image file */
+		FileMap image;
+
+		/* for statistics */
+		size_t no_of_words;
+
+		return_code build_dawg(vector<std::string_view>& words);
+		return_code pack_edges(const vector<uint32_t>& targets, const vector<uint32_t>& words_before);
+		static uint64_t image_checksum(uint64_t checksum, const char *data, size_t size);
+		static bool check_image(const ImageHeader& header, const DawgNode *nodes, const DawgEdge *edges, const uint32_t *overflow_words);
+
+	public:
+
+		enum { NOT_FOUND, WORD_FOUND, PREFIX_FOUND };
+
+		/* cursor to a prefix in the word list (NO_NODE - no word starts with that prefix)                           *
+		 * bits 0..31 - dawg node index; bits 32..63 - number of words before the prefix in sorted order (word id) */
+		typedef uint64_t Node;
+		static constexpr Node NO_NODE = UINT64_MAX;
+
+		WordList() : nodes(NULL), edges(NULL), required_letters(NULL), overflow_words(NULL), no_of_nodes(0), no_of_edges(0), no_of_overflow_words(0),
+			target_bits(0), target_mask(0), overflow_base(0), no_of_words(0) {}
+		~WordList() {}
+		WordList(const WordList&) = delete;
+		WordList& operator=(const WordList&) = delete;
+		return_code BuildWorldList(const char *file_name);
 		int FindWord(const char *word) const;
+
+		/* binary image file: SaveImage writes the built dawg, LoadImage maps it (no parsing, no allocation) */
+		return_code SaveImage(const char *file_name) const;
+		return_code LoadImage(const char *file_name);
+		static bool IsImage(const char *file_name);
+
+		/* cursor API: Root() is the empty prefix, Step() appends one character to the prefix of node */
+		Node Root() const { return 0; }
+		Node Step(Node node, char ch) const
+		{
+			uint32_t c = (uint32_t)(ch - 'a');
+			const DawgNode& dawg_node = nodes[(uint32_t)node];
+			uint32_t bit = 1u << (c & 31);
+
+			if ((c >= NO_OF_CHARS) || ((dawg_node.children & bit) == 0))
+				return NO_NODE;
+
+			DawgEdge edge = edges[dawg_node.first_edge + bit_count(dawg_node.children & (bit - 1))];
+			uint32_t words_before = edge >> target_bits;
+			if (words_before >= overflow_base)
+				words_before = overflow_words[words_before - overflow_base];
+			return (node & 0xffffffff00000000ULL) + ((uint64_t)words_before << 32) + (edge & target_mask);
+		}
+		bool IsWord(Node node) const { return (nodes[(uint32_t)node].children & IS_WORD_BIT) != 0; }
+
+		/* letters that every word starting with the prefix of node has after the prefix (0 if the prefix is a word) */
+		uint32_t RequiredLetters(Node node) const { return required_letters[(uint32_t)node]; }
+
+		/* characters that some word starting with the prefix of node has right after the prefix - the children bitmap */
+		uint32_t NextChars(Node node) const { return nodes[(uint32_t)node].children & ALL_LETTERS; }
+
+		/* word id: a distinct number in 0..GetNoOfWordIds()-1 for every word (valid only if IsWord(node)) */
+		uint32_t WordId(Node node) const { return (uint32_t)(node >> 32); }
+		size_t GetNoOfWordIds() const { return no_of_words; }
+
+		/* statistics */
+		size_t GetNoOfWords() const { return no_of_words; }
+		size_t GetNoOfNodes() const { return no_of_nodes; }
+		size_t GetMemUsage() const { return no_of_nodes * (sizeof(DawgNode) + sizeof(uint32_t)) + no_of_edges * sizeof(DawgEdge) + no_of_overflow_words * sizeof(uint32_t); }
 	};
 }
 
@@ -0,0 +1,510 @@
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "gen_defs.h"
+#include "word_list.h"
+#include "words_grid.h"
+#include "word_search.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include "board_generator.h"
+
+/* ids of loaded word lists (a words grid kept by a thread is reused only with the word list it was made for) */
+static std::atomic<uint64_t> next_word_list_id(1);
+
+/* word list of the dictionary's backend: solving is dispatched to the backend once per grid (WordsGrid itself calls *
+ * the backend's cursor API directly)                                                                               */
+struct Dictionary::word_list_base
+{
+	const uint64_t id;
+
+	word_list_base() : id(next_word_list_id++) {}
+	virtual ~word_list_base() {}
+	virtual return_code Build(const char *file_name) = 0;
+	virtual bool HasWord(const char *word) const = 0;
+	virtual return_code Solve(const char *grid, WordSink& sink, int *no_found_words, ThreadPool *pool) const = 0;
+	virtual return_code Score(const std::string *grids, size_t no_of_grids, BoardScore *scores) const = 0;
+	virtual void Generate(const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool) const = 0;
+};
+
+template <class WL>
+struct word_list_of : public Dictionary::word_list_base
+{
+	WL word_list;
+
+	return_code Build(const char *file_name) override { return word_list.BuildWorldList(file_name); }
+	bool HasWord(const char *word) const override { return word_list.FindWord(word) == WL::WORD_FOUND; }
+	return_code Solve(const char *grid, WordSink& sink, int *no_found_words, ThreadPool *pool) const override;
+	return_code Score(const std::string *grids, size_t no_of_grids, BoardScore *scores) const override;
+	void Generate(const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool) const override { GenerateBoards(word_list, options, boards, pool); }
+};
+
+/*******************************************************************************************************************************************************/
+/************************************************************ internal functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: word_list_of::Solve                                                                                       *
+*                                                                                                                     *
+* DESCRIPTION: solve one grid with the word list on this thread's words grid                                          *
+*                                                                                                                     *
+* PARAMETERS: grid (in) - grid string (see ParseGrid)                                                                 *
+*             sink (in) - result sink of the found words                                                              *
+*             no_found_words (out) - number of found words (may be NULL)                                              *
+*             pool (in) - thread pool to search on (NULL - search on the calling thread)                              *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_INVALID_GRID - invalid grid string (nothing is output)                                                *
+*                                                                                                                     *
+* NOTES: every thread keeps one words grid (and its found words dedup table) for the last word list it solved with -  *
+*        a words grid already in use on this thread (Solve called from a sink or from a pool task run while waiting)  *
+*        is not reused, a temporary one is made instead                                                               *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+return_code word_list_of<WL>::Solve(const char *grid, WordSink& sink, int *no_found_words, ThreadPool *pool) const
+{
+	struct cached_grid
+	{
+		uint64_t word_list_id;
+		bool in_use;
+		std::unique_ptr<WordsGridAnySize<WL> > words_grid;
+	};
+	static thread_local cached_grid cache = { 0, false, NULL };
+
+	std::unique_ptr<WordsGridAnySize<WL> > temp_grid;
+	WordsGridAnySize<WL> *words_grid;
+
+	if (cache.in_use)
+	{
+		temp_grid.reset(new WordsGridAnySize<WL>(word_list));
+		words_grid = temp_grid.get();
+	}
+	else
+	{
+		if ((cache.words_grid == NULL) || (cache.word_list_id != id))
+		{
+			cache.words_grid.reset(new WordsGridAnySize<WL>(word_list));
+			cache.word_list_id = id;
+		}
+		words_grid = cache.words_grid.get();
+		cache.in_use = true;
+	}
+
+	return_code ret_code = words_grid->SetGrid(grid);
+	if (ret_code == RC_NO_ERROR)
+	{
+		words_grid->SetOutputSink(&sink);
+		if (pool != NULL)
+		{
+			words_grid->OutputFoundWords(*pool);
+		}
+		else
+		{
+			words_grid->OutputFoundWords();
+		}
+		words_grid->SetOutputSink(NULL);
+
+		if (no_found_words != NULL)
+		{
+			*no_found_words = words_grid->GetNoFoundWords();
+		}
+	}
+
+	if (temp_grid == NULL)
+	{
+		cache.in_use = false;
+	}
+
+	return ret_code;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: word_list_of::Score                                                                                       *
+*                                                                                                                     *
+* DESCRIPTION: score boards with the word list one after another on one words grid                                   *
+*                                                                                                                     *
+* PARAMETERS: grids (in) - grid strings (see ParseGrid)                                                               *
+*             no_of_grids (in) - number of grids                                                                      *
+*             scores (out) - score of every grid                                                                      *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_INVALID_GRID - some grid string is invalid (its score is -1 words, the others are scored)             *
+*                                                                                                                     *
+* NOTES: each board is set and searched on its own, as Solve would (SetGrid rebuilds its neighbor tables) - only the   *
+*        words grid is made once (its found words dedup table is reused) and the found words are only counted        *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+return_code word_list_of<WL>::Score(const std::string *grids, size_t no_of_grids, BoardScore *scores) const
+{
+	WordsGridAnySize<WL> words_grid(word_list);
+	int total_length = 0;
+	auto add_length = [&total_length](const char *, size_t word_len) { total_length += (int)word_len; };
+	CallableSink<decltype(add_length)> sink(add_length);
+	return_code ret_code = RC_NO_ERROR;
+	size_t i;
+
+	words_grid.SetOutputSink(&sink);
+	for (i = 0; i < no_of_grids; i++)
+	{
+		if (words_grid.SetGrid(grids[i].c_str()) != RC_NO_ERROR)
+		{
+			scores[i] = BoardScore{ -1, 0 };
+			ret_code = RC_INVALID_GRID;
+			continue;
+		}
+
+		total_length = 0;
+		words_grid.OutputFoundWords();
+		scores[i] = BoardScore{ words_grid.GetNoFoundWords(), total_length };
+	}
+
+	return ret_code;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: check_candidates                                                                                          *
+*                                                                                                                     *
+* DESCRIPTION: search a grid once with a word list of the words to check and mark the checked words found in it       *
+*                                                                                                                     *
+* PARAMETERS: grid (in) - valid grid string (see ParseGrid)                                                           *
+*             candidates (in) - the checked words that are in the dictionary (reordered by the build)                 *
+*             words (in) - checked words                                                                              *
+*             found (out) - found[i] is set if words[i] is found in the grid                                          *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: the words make a WordListArray (the fastest to build) - every backend keeps words of 'a'..'z' only           *
+*                                                                                                                     *
+***********************************************************************************************************************/
+static void check_candidates(const char *grid, std::vector<std::string_view>& candidates, const std::vector<std::string>& words, std::vector<bool>& found)
+{
+	std::unordered_set<std::string> found_words;
+	WordListArray::WordList candidate_list;
+	size_t i;
+
+	candidate_list.BuildWorldList(candidates);
+
+	WordsGridAnySize<WordListArray::WordList> words_grid(candidate_list);
+	auto add_found = [&found_words](const char *word, size_t word_len) { found_words.emplace(word, word_len); };
+	CallableSink<decltype(add_found)> sink(add_found);
+
+	words_grid.SetGrid(grid);
+	words_grid.SetOutputSink(&sink);
+	words_grid.OutputFoundWords();
+
+	for (i = 0; i < words.size(); i++)
+	{
+		if (found_words.count(words[i]) > 0)
+			found[i] = true;
+	}
+}
+
+/*******************************************************************************************************************************************************/
+/************************************************************ external functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
+
+Dictionary::Dictionary(Backend _backend) : backend(_backend)
+{
+}
+
+Dictionary::~Dictionary()
+{
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Dictionary::Load                                                                                          *
+*                                                                                                                     *
+* DESCRIPTION: build the dictionary's word list from a word list file (or a compiled image file - dawg backend only)  *
+*                                                                                                                     *
+* PARAMETERS: file_name (in) - word list file name (or image file name)                                               *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_FILE_NOT_FOUND - file not found                                                                       *
+*            RC_BAD_IMAGE - image file of another version, corrupted or given to another backend than dawg            *
+*            RC_NO_MEM - no memory                                                                                    *
+*                                                                                                                     *
+* NOTES: the word list loaded before (if any) is kept if loading fails; must not be called while solving with it      *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code Dictionary::Load(const char *file_name)
+{
+	std::unique_ptr<word_list_base> new_word_list;
+	return_code ret_code;
+
+	if ((backend != BACKEND_DAWG) && WordListDawg::WordList::IsImage(file_name))
+	{
+		return RC_BAD_IMAGE; /* only the dawg backend loads a compiled image file */
+	}
+
+	switch (backend)
+	{
+	case BACKEND_TREE: new_word_list.reset(new word_list_of<WordListTree::WordList>); break;
+	case BACKEND_SET: new_word_list.reset(new word_list_of<WordListSet::WordList>); break;
+	case BACKEND_ARRAY: new_word_list.reset(new word_list_of<WordListArray::WordList>); break;
+	default: new_word_list.reset(new word_list_of<WordListDawg::WordList>); break;
+	}
+
+	ret_code = new_word_list->Build(file_name);
+	if (ret_code != RC_EOF)
+	{
+		return ret_code;
+	}
+
+	word_list = std::move(new_word_list);
+	if (cache != NULL)
+	{
+		SetCacheSize(cache->GetMaxEntries()); /* results of the word list loaded before are not valid */
+	}
+	return RC_NO_ERROR;
+}
+
+void Dictionary::SetCacheSize(size_t max_grids)
+{
+	cache.reset((max_grids > 0) ? new ResultCache(max_grids) : NULL);
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: Solve                                                                                                     *
+*                                                                                                                     *
+* DESCRIPTION: output (to sink) the found words of a grid with a loaded dictionary                                    *
+*                                                                                                                     *
+* PARAMETERS: dictionary (in) - loaded dictionary                                                                     *
+*             grid (in) - grid string (see ParseGrid)                                                                 *
+*             sink (in) - result sink of the found words (every found word once)                                      *
+*             no_found_words (out) - number of found words (may be NULL)                                              *
+*             pool (in) - thread pool to search on (NULL - search on the calling thread)                              *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_INVALID_GRID - invalid grid string (nothing is output)                                                *
+*            RC_FILE_NOT_FOUND - no word list loaded in dictionary                                                    *
+*                                                                                                                     *
+* NOTES: safe to call from many threads at once (with the same dictionary or different ones)                         *
+*        with the dictionary's result cache: a hit outputs the cached words, a miss is searched and its words are     *
+*        sorted, output and cached (two threads that miss the same grid at once both search it)                      *
+*        a sink that wants paths is always searched (the cache keeps words only, and a rotated grid has other cells)  *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code Solve(const Dictionary& dictionary, const char *grid, WordSink& sink, int *no_found_words, ThreadPool *pool)
+{
+	ResultCache *cache = dictionary.GetCache();
+	std::vector<std::string> found;
+	std::string cells, key, words;
+	return_code ret_code;
+	int x_len, y_len, no_of_words = 0;
+	size_t start, end;
+
+	if (dictionary.IsLoaded() == false)
+	{
+		return RC_FILE_NOT_FOUND;
+	}
+
+	if ((cache == NULL) || sink.WantsPaths())
+	{
+		return dictionary.GetWordList()->Solve(grid, sink, no_found_words, pool);
+	}
+
+	if (ParseGrid(grid, &x_len, &y_len, &cells) != RC_NO_ERROR)
+	{
+		return RC_INVALID_GRID;
+	}
+
+	ResultCache::CanonicalKey(x_len, y_len, cells, key);
+	if (cache->Find(key, words, &no_of_words) == false)
+	{
+		VectorSink found_sink(found);
+
+		ret_code = dictionary.GetWordList()->Solve(grid, found_sink, &no_of_words, pool);
+		if (ret_code != RC_NO_ERROR)
+		{
+			return ret_code;
+		}
+
+		std::sort(found.begin(), found.end());
+		for (const std::string& word : found)
+		{
+			words.append(word);
+			words.push_back('\n');
+		}
+		cache->Add(key, words, no_of_words);
+	}
+
+	for (start = 0; start < words.length(); start = end + 1)
+	{
+		end = words.find('\n', start);
+		words[end] = '\0';
+		sink.Word(&words[start], end - start);
+	}
+
+	if (no_found_words != NULL)
+	{
+		*no_found_words = no_of_words;
+	}
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: CheckWords                                                                                                *
+*                                                                                                                     *
+* DESCRIPTION: check words (e.g. a player's submitted words) against one grid - whether each one is in the            *
+*              dictionary and can be traced on the grid                                                               *
+*                                                                                                                     *
+* PARAMETERS: dictionary (in) - loaded dictionary                                                                     *
+*             grid (in) - grid string (see ParseGrid)                                                                 *
+*             words (in) - words to check (may repeat)                                                                *
+*             found (out) - found[i]: words[i] is in the dictionary and is found in the grid (same size as words)     *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_INVALID_GRID - invalid grid string (found is all false)                                               *
+*            RC_FILE_NOT_FOUND - no word list loaded in dictionary                                                    *
+*                                                                                                                     *
+* NOTES: the words that are in the dictionary make a small word list of their own (see check_candidates) and the      *
+*        searched once with it: a prefix shared by many words is searched once and the search stops where no checked  *
+*        word goes on - it never walks the dictionary. no state is kept (reentrant); the result cache is not used     *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code CheckWords(const Dictionary& dictionary, const char *grid, const std::vector<std::string>& words, std::vector<bool>& found)
+{
+	std::vector<std::string_view> candidates;
+	int x_len, y_len;
+
+	found.assign(words.size(), false);
+
+	if (dictionary.IsLoaded() == false)
+	{
+		return RC_FILE_NOT_FOUND;
+	}
+
+	if (ParseGrid(grid, &x_len, &y_len, NULL) != RC_NO_ERROR)
+	{
+		return RC_INVALID_GRID;
+	}
+
+	for (const std::string& word : words)
+	{
+		if ((word.empty() == false) && dictionary.GetWordList()->HasWord(word.c_str()))
+		{
+			candidates.push_back(word);
+		}
+	}
+	if (candidates.empty())
+	{
+		return RC_NO_ERROR;
+	}
+
+	check_candidates(grid, candidates, words, found);
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: ScoreBoards                                                                                               *
+*                                                                                                                     *
+* DESCRIPTION: score many boards (e.g. generated ones) - the number of found words of each and their total length     *
+*                                                                                                                     *
+* PARAMETERS: dictionary (in) - loaded dictionary                                                                     *
+*             grids (in) - grid strings (see ParseGrid)                                                               *
+*             scores (out) - scores[i]: the score of grids[i] (same size as grids)                                    *
+*             pool (in) - thread pool to score on (NULL - score on the calling thread)                                *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_INVALID_GRID - some grid string is invalid (its score is -1 words, the others are scored)             *
+*            RC_FILE_NOT_FOUND - no word list loaded in dictionary                                                    *
+*                                                                                                                     *
+* NOTES: a convenience over Solve, not a multi board search: the scores are the same as Solve's (no_found_words and   *
+*        the found words' lengths), each board is searched on its own (see word_list_of::Score) - a pool task scores  *
+*        a range of the boards on one words grid                                                                      *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code ScoreBoards(const Dictionary& dictionary, const std::vector<std::string>& grids, std::vector<BoardScore>& scores, ThreadPool *pool)
+{
+	/* boards scored by one task at least (a task makes its own words grid) */
+	const size_t MIN_GRIDS_PER_TASK = 256;
+
+	const Dictionary::word_list_base *word_list = dictionary.GetWordList();
+	std::atomic<bool> invalid_grid(false);
+	size_t grids_per_task, i;
+
+	scores.assign(grids.size(), BoardScore{ 0, 0 });
+
+	if (dictionary.IsLoaded() == false)
+	{
+		return RC_FILE_NOT_FOUND;
+	}
+
+	if ((pool == NULL) || (grids.size() <= MIN_GRIDS_PER_TASK))
+	{
+		return grids.empty() ? RC_NO_ERROR : word_list->Score(grids.data(), grids.size(), scores.data());
+	}
+
+	/* a few tasks per thread (a thread that is done early steals the rest) */
+	grids_per_task = std::max(MIN_GRIDS_PER_TASK, grids.size() / ((size_t)pool->GetNoOfThreads() * 4));
+	for (i = 0; i < grids.size(); i += grids_per_task)
+	{
+		size_t no_of_grids = std::min(grids_per_task, grids.size() - i);
+
+		pool->Submit([word_list, &grids, &scores, &invalid_grid, i, no_of_grids]()
+		{
+			if (word_list->Score(&grids[i], no_of_grids, &scores[i]) != RC_NO_ERROR)
+				invalid_grid = true;
+		});
+	}
+	pool->Wait();
+
+	return invalid_grid ? RC_INVALID_GRID : RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: GenerateBoards                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: generate boards - the best boards found for an objective under a time budget (see board_generator.h)   *
+*                                                                                                                     *
+* PARAMETERS: dictionary (in) - loaded dictionary                                                                     *
+*             options (in) - board size, objective, time budget, number of boards and seed (see GenerateOptions)      *
+*             boards (out) - the best boards found (best first)                                                       *
+*             pool (in) - thread pool to generate on (NULL - on the calling thread)                                   *
+*                                                                                                                     *
+* RETURN:    RC_NO_ERROR - no error                                                                                   *
+*            RC_INVALID_GRID - board size of no cells or of more than GenerateOptions::MAX_CELLS (64) cells           *
+*            RC_FILE_NOT_FOUND - no word list loaded in dictionary                                                    *
+*                                                                                                                     *
+* NOTES: runs for options.seconds (each chain checks the time after every change); the result cache is not used       *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code GenerateBoards(const Dictionary& dictionary, const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool)
+{
+	boards.clear();
+
+	if (dictionary.IsLoaded() == false)
+	{
+		return RC_FILE_NOT_FOUND;
+	}
+
+	if ((options.x_len <= 0) || (options.y_len <= 0) || ((options.x_len * options.y_len) > GenerateOptions::MAX_CELLS))
+	{
+		return RC_INVALID_GRID;
+	}
+
+	if (options.no_of_boards > 0)
+	{
+		dictionary.GetWordList()->Generate(options, boards, pool);
+	}
+
+	return RC_NO_ERROR;
+}
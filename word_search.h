@@ -0,0 +1,106 @@
+#ifndef _WORD_SEARCH_H_
+#define _WORD_SEARCH_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gen_defs.h"
+#include "word_sink.h"
+#include "result_cache.h"
+
+class ThreadPool;
+
+/* word search library API (every .cpp file but main.cpp, bench.cpp, load_client.cpp and word_search_test.cpp - the  *
+ * static library target word_search_lib of CMakeLists.txt):                                                          *
+ *     Dictionary dictionary(Dictionary::BACKEND_DAWG);                                                               *
+ *     dictionary.Load("word.list");                                                                                  *
+ *     Solve(dictionary, "abanzqzdrrorrnrr", sink);                                                                   *
+ * a loaded dictionary is read only - Solve may be called with it from many threads at once                           */
+
+/* dictionary: a word list of one of the WordList backends */
+class Dictionary
+{
+public:
+	enum Backend { BACKEND_TREE, BACKEND_SET, BACKEND_ARRAY, BACKEND_DAWG, NO_OF_BACKENDS };
+
+	/* word list of the dictionary's backend (defined in word_search.cpp) */
+	struct word_list_base;
+
+private:
+	Backend backend;
+	std::unique_ptr<word_list_base> word_list;
+
+	/* found words of recently solved grids (NULL - no cache) */
+	std::unique_ptr<ResultCache> cache;
+
+public:
+
+	explicit Dictionary(Backend backend = BACKEND_DAWG);
+	~Dictionary();
+	Dictionary(const Dictionary&) = delete;
+	Dictionary& operator=(const Dictionary&) = delete;
+
+	return_code Load(const char *file_name);
+	bool IsLoaded() const { return word_list != NULL; }
+	Backend GetBackend() const { return backend; }
+	const word_list_base *GetWordList() const { return word_list.get(); }
+
+	/* result cache of up to max_grids grids (0 - no cache); emptied by Load. not to be called while solving */
+	void SetCacheSize(size_t max_grids);
+	ResultCache *GetCache() const { return cache.get(); }
+};
+
+/* solve one grid (see ParseGrid) with a loaded dictionary: every found word goes to sink once                         *
+ * (on a thread pool if pool != NULL - the words go to sink sorted, on the calling thread, after the search)         *
+ * with a result cache the words always go to sink sorted, and a cached grid (or a rotation or reflection of it) is   *
+ * answered without a search (unless the sink wants paths - see WordSink::WantsPaths)                                 *
+ * reentrant - calls share only the result cache (locked); each thread keeps its own words grid                     */
+return_code Solve(const Dictionary& dictionary, const char *grid, WordSink& sink, int *no_found_words = NULL, ThreadPool *pool = NULL);
+
+/* check words against one grid (e.g. a player's submitted words): found[i] - words[i] is in the dictionary and can   *
+ * be traced on the grid. only the checked words are searched for (their common prefixes once), not the dictionary    *
+ * reentrant - no state is kept between calls                                                                        */
+return_code CheckWords(const Dictionary& dictionary, const char *grid, const std::vector<std::string>& words, std::vector<bool>& found);
+
+/* score of a board (see ScoreBoards) */
+struct BoardScore
+{
+	int no_of_words;  /* found words (-1 - invalid grid) */
+	int total_length; /* characters of all found words */
+};
+
+/* score many boards (e.g. generated ones) without outputting their words: scores[i] - the found words of grids[i]    *
+ * a convenience over Solve - each board is searched on its own, one after another on a reused words grid (on a      *
+ * thread pool if pool != NULL - ranges of the boards are split among its threads); the result cache is not used     */
+return_code ScoreBoards(const Dictionary& dictionary, const std::vector<std::string>& grids, std::vector<BoardScore>& scores, ThreadPool *pool = NULL);
+
+/* what and how long GenerateBoards searches for */
+struct GenerateOptions
+{
+	enum Objective { MOST_WORDS, LONGEST_WORDS, TARGET_WORDS };
+
+	/* largest board (x_len * y_len) */
+	enum { MAX_CELLS = 64 };
+
+	int x_len, y_len;       /* board size (up to MAX_CELLS cells) */
+	Objective objective;    /* most found words, largest total length of the found words or found words closest to target_words */
+	int target_words;       /* TARGET_WORDS: the difficulty (fewer found words - a harder board) */
+	double seconds;         /* time budget */
+	size_t no_of_boards;    /* number of best boards to return */
+	unsigned seed;          /* seed of the random boards and changes */
+};
+
+/* a generated board: grid string (see ParseGrid) and its score */
+struct GeneratedBoard
+{
+	std::string grid;
+	BoardScore score;
+};
+
+/* generate boards of a size: simulated annealing over the letters of random boards (one cell changed at a time and   *
+ * searched incrementally) until the time budget is spent - boards gets the best boards found (best first, a rotation *
+ * or reflection of a board is not repeated); on a thread pool if pool != NULL - one annealing chain per thread      */
+return_code GenerateBoards(const Dictionary& dictionary, const GenerateOptions& options, std::vector<GeneratedBoard>& boards, ThreadPool *pool = NULL);
+
+#endif // _WORD_SEARCH_H_
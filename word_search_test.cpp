@@ -0,0 +1,279 @@
+/* word search tests - a separate program (not linked into word_search.exe), run by ctest (see CMakeLists.txt):        *
+ * the filtered search (see WordsGrid::SetFiltered) against the plain search over a fixed corpus of seeded random      *
+ * grids, for every WordList backend: the found words with their paths, the search on a thread pool and ScoreBoards;  *
+ * and BoardSearch's incremental score over seeded random SetCell / UndoSetCell sequences against the plain search   *
+ * of the same board; the first mismatch of a test is written to the standard error and the exit code is 1 if any   *
+ * test failed                                                                                                        */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "gen_defs.h"
+#include "word_list.h"
+#include "words_grid.h"
+#include "word_search.h"
+#include "board_generator.h"
+#include "thread_pool.h"
+
+using std::string;
+using std::vector;
+
+/* seed of the corpus */
+const unsigned SEED = 12345;
+
+/* grids of each size */
+const int NO_OF_GRIDS = 150;
+
+/* grid sizes of the corpus (rows, columns): the words grids of a fixed size (4x4, 5x5, 6x6) and the any size one */
+static const int grid_sizes[][2] = { { 4, 4 }, { 5, 5 }, { 6, 6 }, { 3, 3 }, { 2, 7 }, { 8, 8 } };
+
+/* BoardSearch: board sizes (rows, columns - up to GenerateOptions::MAX_CELLS cells), boards of each size and changes *
+ * of each board                                                                                                       */
+static const int board_sizes[][2] = { { 4, 4 }, { 5, 5 }, { 3, 6 }, { 8, 8 } };
+const int NO_OF_BOARDS = 4;
+const int NO_OF_CHANGES = 250;
+
+/* random cell character: a letter by its frequency in English text, or rarely not a letter (no word steps on it) */
+static char random_char (std::mt19937& random)
+{
+	static const char letters[] = "eeeeeeeeeeeettttttttaaaaaaaaoooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllccuuummwwffggyyppbbvkjxqz**";
+
+	return letters[random() % (sizeof(letters) - 1)];
+}
+
+/* grid string (see ParseGrid) of x_len rows of y_len cells - the cells' characters row by row */
+static string grid_string (const string& cells, int x_len, int y_len)
+{
+	string grid;
+
+	if (x_len == y_len)
+	{
+		return cells;
+	}
+
+	for (int x = 0; x < x_len; x++)
+	{
+		grid += cells.substr(x * y_len, y_len) + '/';
+	}
+
+	return grid;
+}
+
+/* random grid string of x_len rows of y_len cells (see random_char) */
+static string random_grid (std::mt19937& random, int x_len, int y_len)
+{
+	string cells;
+
+	for (int i = 0; i < x_len * y_len; i++)
+	{
+		cells.push_back(random_char(random));
+	}
+
+	return grid_string(cells, x_len, y_len);
+}
+
+static void make_corpus (vector<string>& corpus)
+{
+	std::mt19937 random(SEED);
+
+	corpus.push_back("abanzqzdrrorrnrr");
+	corpus.push_back("aahebcidbengmika");
+	for (const int *size : grid_sizes)
+	{
+		for (int i = 0; i < NO_OF_GRIDS; i++)
+		{
+			corpus.push_back(random_grid(random, size[0], size[1]));
+		}
+	}
+}
+
+/* the found words of grid as StringSink writes them (with their paths if paths), sorted by line if pool != NULL (a  *
+ * pool search outputs the words in no fixed order and may find a word on another path - its paths are not compared) */
+template <class WL>
+static string found_words (WordsGridAnySize<WL>& words_grid, const string& grid, bool paths, ThreadPool *pool = NULL)
+{
+	string found;
+	StringSink sink(found, paths);
+	vector<string> lines;
+	size_t start, end;
+
+	words_grid.SetOutputSink(&sink);
+	if (words_grid.SetGrid(grid.c_str()) != RC_NO_ERROR)
+	{
+		return "invalid grid";
+	}
+
+	if (pool == NULL)
+	{
+		words_grid.OutputFoundWords();
+		return found;
+	}
+
+	words_grid.OutputFoundWords(*pool);
+	for (start = 0; (end = found.find('\n', start)) != string::npos; start = end + 1)
+	{
+		lines.push_back(found.substr(start, end - start + 1));
+	}
+	std::sort(lines.begin(), lines.end());
+	found.clear();
+	for (const string& line : lines)
+	{
+		found += line;
+	}
+
+	return found;
+}
+
+/* report a mismatch of a test on a grid */
+static bool check (bool same, const char *name, const char *test, const string& grid)
+{
+	if (same == false)
+	{
+		std::cerr << name << ": " << test << " differs from the plain search on grid " << grid << std::endl;
+	}
+
+	return same;
+}
+
+/* the filtered search, the search on a thread pool and ScoreBoards against the plain search */
+template <class WL>
+static bool test_filters (const char *name, const WL& word_list, const Dictionary& dictionary, const vector<string>& corpus)
+{
+	WordsGridAnySize<WL> filtered(word_list), plain(word_list);
+	ThreadPool pool(2);
+	vector<BoardScore> scores;
+	bool ok[3] = { true, true, true };
+	size_t i;
+
+	plain.SetFiltered(false);
+	ScoreBoards(dictionary, corpus, scores, &pool);
+
+	for (i = 0; i < corpus.size(); i++)
+	{
+		const string& grid = corpus[i];
+		string expected = found_words(plain, grid, false);
+		int no_of_words = plain.GetNoFoundWords();
+
+		if (ok[0])
+		{
+			ok[0] = check(found_words(filtered, grid, true) == found_words(plain, grid, true), name, "search", grid);
+		}
+		if (ok[1])
+		{
+			ok[1] = check(found_words(filtered, grid, false, &pool) == found_words(plain, grid, false, &pool), name, "thread pool search", grid);
+		}
+		if (ok[2])
+		{
+			ok[2] = check((scores[i].no_of_words == no_of_words) && ((size_t)scores[i].total_length + no_of_words == expected.size()), /* a '\n' after every word */
+			              name, "ScoreBoards", grid);
+		}
+	}
+
+	std::cout << name << ": search of " << corpus.size() << " grids " << ((ok[0] && ok[1] && ok[2]) ? "OK" : "FAILED") << std::endl;
+
+	return ok[0] && ok[1] && ok[2];
+}
+
+/* BoardSearch: after SetBoard and after every SetCell and UndoSetCell of a random sequence, its score against the    *
+ * plain search of its board                                                                                           */
+template <class WL>
+static bool test_board_search (const char *name, const WL& word_list)
+{
+	std::mt19937 random(SEED + 1);
+	WordsGridAnySize<WL> plain(word_list);
+	int total_length = 0, no_of_changes = 0;
+	auto add_length = [&total_length](const char *, size_t word_len) { total_length += (int)word_len; };
+	CallableSink<decltype(add_length)> sink(add_length);
+	bool ok = true;
+
+	/* the score of the board against the plain search (what - the last call) */
+	auto check_board = [&](const BoardSearch<WL>& board, int x_len, int y_len, const char *what)
+	{
+		string grid = grid_string(board.GetCells(), x_len, y_len);
+
+		total_length = 0;
+		plain.SetGrid(grid.c_str());
+		plain.OutputFoundWords();
+		return check((board.GetNoFoundWords() == plain.GetNoFoundWords()) && (board.GetTotalLength() == total_length), name, what, grid);
+	};
+
+	plain.SetFiltered(false);
+	plain.SetOutputSink(&sink);
+	for (const int *size : board_sizes)
+	{
+		BoardSearch<WL> board(word_list, size[0], size[1]);
+		int no_of_cells = size[0] * size[1];
+
+		for (int b = 0; (b < NO_OF_BOARDS) && ok; b++)
+		{
+			string cells;
+
+			while ((int)cells.size() < no_of_cells)
+			{
+				cells.push_back(random_char(random));
+			}
+			board.SetBoard(cells.c_str());
+			ok = check_board(board, size[0], size[1], "BoardSearch::SetBoard");
+
+			for (int c = 0; (c < NO_OF_CHANGES) && ok; c++, no_of_changes++)
+			{
+				board.SetCell(random() % no_of_cells, random_char(random));
+				ok = check_board(board, size[0], size[1], "BoardSearch::SetCell");
+				if (ok && (random() % 3 == 0))
+				{
+					board.UndoSetCell();
+					ok = check_board(board, size[0], size[1], "BoardSearch::UndoSetCell");
+				}
+			}
+		}
+	}
+
+	std::cout << name << ": BoardSearch of " << no_of_changes << " changes " << (ok ? "OK" : "FAILED") << std::endl;
+
+	return ok;
+}
+
+/* one backend: the search and BoardSearch tests with its word list */
+template <class WL>
+static bool test_backend (const char *name, Dictionary::Backend backend, const char *word_list_file, const vector<string>& corpus)
+{
+	WL word_list;
+	Dictionary dictionary(backend);
+	return_code ret_code;
+	bool ok = true;
+
+	ret_code = word_list.BuildWorldList(word_list_file);
+	if ((ret_code != RC_EOF) || ((ret_code = dictionary.Load(word_list_file)) != RC_NO_ERROR))
+	{
+		std::cerr << name << ": can't load word list " << word_list_file << " (error code #" << ret_code << ")" << std::endl;
+		return false;
+	}
+
+	ok &= test_filters(name, word_list, dictionary, corpus);
+	ok &= test_board_search(name, word_list);
+
+	return ok;
+}
+
+int main (int argc, char* argv[])
+{
+	vector<string> corpus;
+	bool ok = true;
+
+	if (argc != 2)
+	{
+		std::cout << "Usage: word_search_test.exe <word-list-file>\n";
+		return 1;
+	}
+
+	make_corpus(corpus);
+	ok &= test_backend<WordListTree::WordList>("WordListTree", Dictionary::BACKEND_TREE, argv[1], corpus);
+	ok &= test_backend<WordListSet::WordList>("WordListSet", Dictionary::BACKEND_SET, argv[1], corpus);
+	ok &= test_backend<WordListArray::WordList>("WordListArray", Dictionary::BACKEND_ARRAY, argv[1], corpus);
+	ok &= test_backend<WordListDawg::WordList>("WordListDawg", Dictionary::BACKEND_DAWG, argv[1], corpus);
+
+	return ok ? 0 : 1;
+}
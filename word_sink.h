@@ -0,0 +1,96 @@
+#ifndef _WORD_SINK_H_
+#define _WORD_SINK_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* result sink: receives every found word of a words grid search (word is null terminated, word_len is its length) *
+ * Word() is called on the searching thread - with a thread pool search only after the search, on the caller's thread *
+ * a sink whose WantsPaths() is true gets WordPath() instead: the word and the cells of one path that spells it on   *
+ * the grid (word_len cell indices, cell index = row * columns + column), taken from the search as it finds the word */
+class WordSink
+{
+public:
+	virtual ~WordSink() {}
+	virtual void Word(const char *word, size_t word_len) = 0;
+	virtual bool WantsPaths() const { return false; }
+	virtual void WordPath(const char *word, size_t word_len, const uint16_t *) { Word(word, word_len); }
+};
+
+/* appends a found word and its path to a buffer as one line: "<word> <cell> <cell> ..." */
+inline void AppendWordPath(std::string& buffer, const char *word, size_t word_len, const uint16_t *cells)
+{
+	size_t i;
+
+	buffer.append(word, word_len);
+	for (i = 0; i < word_len; i++)
+	{
+		buffer.push_back(' ');
+		buffer.append(std::to_string(cells[i]));
+	}
+	buffer.push_back('\n');
+}
+
+/* collects found words into a caller-owned vector */
+class VectorSink : public WordSink
+{
+private:
+	std::vector<std::string>& words;
+
+public:
+
+	explicit VectorSink(std::vector<std::string>& _words) : words(_words) {}
+	void Word(const char *word, size_t word_len) override { words.emplace_back(word, word_len); }
+};
+
+/* appends found words (one per line, with their paths if paths is true) to a caller-owned string - one buffer for all *
+ * words, no allocation per word                                                                                       */
+class StringSink : public WordSink
+{
+private:
+	std::string& buffer;
+	bool paths;
+
+public:
+
+	explicit StringSink(std::string& _buffer, bool _paths = false) : buffer(_buffer), paths(_paths) {}
+	void Word(const char *word, size_t word_len) override { buffer.append(word, word_len); buffer.push_back('\n'); }
+	bool WantsPaths() const override { return paths; }
+	void WordPath(const char *word, size_t word_len, const uint16_t *cells) override { AppendWordPath(buffer, word, word_len, cells); }
+};
+
+/* buffers found words (one per line, with their paths if paths is true) and writes them to a stream on Flush() (or *
+ * destruction) - one write per grid                                                                                  */
+class StreamSink : public WordSink
+{
+private:
+	std::ostream& stream;
+	std::string buffer;
+	bool paths;
+
+public:
+
+	explicit StreamSink(std::ostream& _stream, bool _paths = false) : stream(_stream), paths(_paths) {}
+	~StreamSink() { Flush(); }
+	void Word(const char *word, size_t word_len) override { buffer.append(word, word_len); buffer.push_back('\n'); }
+	bool WantsPaths() const override { return paths; }
+	void WordPath(const char *word, size_t word_len, const uint16_t *cells) override { AppendWordPath(buffer, word, word_len, cells); }
+	void Flush() { stream.write(buffer.data(), buffer.size()); stream.flush(); buffer.clear(); }
+};
+
+/* calls a callable (e.g. a lambda with its own context) with every found word: CallableSink<F> sink(f) */
+template <class F>
+class CallableSink : public WordSink
+{
+private:
+	F func;
+
+public:
+
+	explicit CallableSink(F _func) : func(_func) {}
+	void Word(const char *word, size_t word_len) override { func(word, word_len); }
+};
+
+#endif // _WORD_SINK_H_
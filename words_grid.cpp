@@ -1,74 +1,72 @@
 #include <cassert>
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "gen_defs.h"
 #include "word_list.h"
 #include "words_grid.h"
+#include "thread_pool.h"
 
-// explicit instantiation
-template WordsGrid<4,4>;
+// explicit instantiation (grid sizes dispatched to by WordsGridAnySize, for every WordList backend)
+#define INSTANTIATE_WORDS_GRID(WL) \
+	template class WordsGrid<WL, 4,4>; \
+	template class WordsGrid<WL, 5,5>; \
+	template class WordsGrid<WL, 6,6>; \
+	template class WordsGrid<WL, GRID_ANY_SIZE, GRID_ANY_SIZE>; \
+	template class WordsGridAnySize<WL>;
 
-/*******************************************************************************************************************************************************/
-/************************************************************ internal functions definition ************************************************************/
-/*******************************************************************************************************************************************************/
+INSTANTIATE_WORDS_GRID(WordListTree::WordList)
+INSTANTIATE_WORDS_GRID(WordListSet::WordList)
+INSTANTIATE_WORDS_GRID(WordListArray::WordList)
+INSTANTIATE_WORDS_GRID(WordListDawg::WordList)
 
-/**********************************************************************************************************************
-* FUNCTION: init_grid                                                                                                *
-*                                                                                                                    *
-* DESCRIPTION: initialise grid to init value                                                                         *
-*                                                                                                                    *
-* PARAMETERS: (in/out) grid                                                                                          *
-*                                                                                                                    *
-* RETURN: none                                                                                                       *
-*                                                                                                                    *
-* NOTES:                                                                                                             *
-*                                                                                                                    *
-**********************************************************************************************************************/
-template <int X, int Y> template <class type>
-void WordsGrid<X, Y>::init_grid(type grid[][Y], int x_len, type init_val)
+/* search on a thread pool: prefixes shorter than split_depth are searched by separate pool tasks, longer ones (up to     *
+ * MAX_SPLIT_DEPTH) while a pool thread is idle (so a large subtree is split among idle threads); every task collects its *
+ * found words and merges them into one list when it is done (a word found by many tasks is kept once)                   */
+template <class WL, int X, int Y>
+struct WordsGrid<WL, X, Y>::parallel_search
 {
-	int i, j;
+	typedef std::pair<std::string, std::vector<uint16_t> > found_word; /* found word and its path (if paths are output) */
 
-	for (i = 0; i < x_len; i++)
-	{
-		for (j = 0; j < Y; j++)
-		{
-			grid[i][j] = init_val;
-		}
-	}
-}
+	ThreadPool& pool;
+	int split_depth;
+	std::mutex lock; /* found and word_epoch */
+	std::vector<found_word> found;
 
-/**********************************************************************************************************************
-* FUNCTION: grid_copy                                                                                                 *
-*                                                                                                                    *
-* DESCRIPTION: copy one grid to another                                                                              *
-*                                                                                                                    *
-* PARAMETERS: (out) grid_dest - destination grid                                                                     *
-*             (in)  grid_src - source grid                                                                           *
-*                                                                                                                    *
-* RETURN: none                                                                                                       *
-*                                                                                                                    *
-* NOTES:                                                                                                             *
-*                                                                                                                    *
-*********************************************************************************************************************/
-template <int X, int Y> template <class type>
-void WordsGrid<X, Y>::grid_copy(type grid_dest[][Y], type grid_src[][Y], int size)
+	parallel_search(ThreadPool& _pool, int _split_depth) : pool(_pool), split_depth(_split_depth) {}
+};
+
+template <class WL, int X, int Y>
+struct WordsGrid<WL, X, Y>::subtree
 {
-	int i, j;
+	std::string word; /* prefix */
+	std::vector<uint16_t> path; /* prefix's cells */
+	typename WL::Node node;
+	int cell;
+};
 
-	for (i = 0; i < size; i++)
-	{
-		for (j = 0; j < Y; j++)
-		{
-			grid_dest[i][j] = grid_src[i][j];
-		}
-	}
-}
+template <class WL, int X, int Y>
+struct WordsGrid<WL, X, Y>::task_buffers
+{
+	int no_of_cells = 0; /* grid size the buffers below are for (0 - not allocated yet) */
+	std::vector<char> word;
+	std::vector<uint16_t> path;
+	std::vector<search_frame> stack;
+	CellSet<X * Y> used; /* no cell is used between tasks */
+	std::vector<std::pair<uint32_t, typename parallel_search::found_word> > found; /* running task's found words (and ids) */
+};
+
+/*******************************************************************************************************************************************************/
+/************************************************************ internal functions definition ************************************************************/
+/*******************************************************************************************************************************************************/
 
 /**********************************************************************************************************************
 *                                                                                                                     *
 * FUNCTION: output_found_words_from_prefix                                                                                *
 *                                                                                                                     *
-* DESCRIPTION: output (calls output_func) all found words from grid that start with a prefix                          *
+* DESCRIPTION: output (to output_sink) all found words from grid that start with a prefix                             *
 *                                                                                                                     *
 * PARAMETERS: words_grid - (in) pointer to words grid w/ word list and a grid e.g.:                                   *
 *                                                                                  +-------+                          *
@@ -81,12 +79,17 @@ void WordsGrid<X, Y>::grid_copy(type grid_dest[][Y], type grid_src[][Y], int siz
 *                                                                                  |k|l|n|z|                          *
 *                                                                                  +-------+                          *
 *                                                                                                                     *
-*             word - (in) prefix string, e.g.: "aband"                                                                *
+*             word - (in) prefix buffer, e.g.: "aband" (not null terminated; the search appends to it in place)       *
+*                                                                                                                     *
+*             path - (in) cells of the prefix, e.g.: 0, 1, 2, 3, 7 (buffer shared as word)                            *
+*                                                                                                                     *
+*             word_len - (in) prefix length, e.g.: 5                                                                  *
+*                                                                                                                     *
+*             node - (in) word list cursor at the prefix (the prefix is known to be a word or a prefix of a word)     *
 *                                                                                                                     *
-*             i,j - (in) the x,y indices of the last character of prefix, e.g.: (1,3)                                 *
+*             cell - (in) the cell index (i * Y + j) of the last character of prefix, e.g.: 7 for (1,3)                *
 *                                                                                                                     *
-*             grid_ctrl - (in) grid control that marks which characters are used (part of prefix) and which aren't    *
-*                                                                                  e.g.: (x = used; o = unused)       *
+*             used - (in) bitmask of the cells used (part of prefix), e.g.: (x = used; o = unused)                    *
 *                                                                                  +-------+                          *
 *                                                                                  |x|x|x|x|                          *
 *                                                                                  +-------+                          *
@@ -96,256 +99,743 @@ void WordsGrid<X, Y>::grid_copy(type grid_dest[][Y], type grid_src[][Y], int siz
 *                                                                                  +-------+                          *
 *                                                                                  |o|o|o|o|                          *
 *                                                                                  +-------+                          *
+*                    bits 0..7 set - 0x8f (restored to the same cells on return)                                      *
+*                                                                                                                     *
+*             stack - (in) search stack of at least grid size - word_len + 1 frames                                   *
 *                                                                                                                     *
 * RETURN: none                                                                                                        *
 *                                                                                                                     *
-* NOTES:                                                                                                              *
+* NOTES: iterative - a frame per prefix character on the explicit stack (no recursion, nothing copied per step), so   *
+*        the search of any grid size needs no more than the stack given                                               *
+*        FILTERED: only the adjacent cells whose character is one of the prefix's next characters (NextChars) are     *
+*        tried - the grid gives them as a bitmask per character (NeighborSlots), so a cell whose character can't go   *
+*        on is never stepped to; a prefix whose words all need a letter that is not in the grid is not extended.      *
+*        otherwise every adjacent cell is stepped to (the plain search - see SetFiltered)                             *
 *                                                                                                                     *
 ***********************************************************************************************************************/
-template <int X, int Y>
-void WordsGrid<X, Y>::output_found_words_from_prefix(char *word, int i, int j, bool grid_ctrl[][Y], int size)
+template <class WL, int X, int Y>
+template <bool FILTERED>
+void WordsGrid<WL, X, Y>::output_found_words_from_prefix(char *word, uint16_t *path, int word_len, typename WL::Node node, int cell, CellSet<X * Y>& used, search_frame *stack)
 {
-	bool grid_ctrl_next[X][Y];
-	char word_next[(X*Y) + 1];
-	int word_found;
-	size_t word_len;
-	int x, y;
-
-	word_found = word_list.FindWord(word);
-	if ((word_found == WordList::WORD_FOUND) || (word_found == WordList::PREFIX_FOUND))
+	search_frame *top = stack; /* frame of the current prefix - its fields are kept in node, cell and slots meanwhile */
+	typename WL::Node next_node = WL::NO_NODE;
+	int next_cell = 0;
+
+	/* the adjacent cells to try (bit k - Neighbor(cell, k)) */
+	uint32_t slots = FILTERED ? grid.NeighborSlots(cell, word_list.NextChars(node)) : ((1u << grid.NeighborCount(cell)) - 1);
+
+	if (word_list.IsWord(node))
 	{
-		if (word_found == WordList::WORD_FOUND)
+		output_found_word(word, path, word_len, node);
+	}
+
+	/* in a loop: 1) take the next adjacent unused cell of the current prefix that its word list cursor steps to *
+	 * 2) push the current prefix's frame and go on with the longer prefix - when no adjacent cell is left, the   *
+	 * frame of the shorter prefix is popped (and the current cell is unused again)                               */
+	while (true)
+	{
+		for (; slots != 0; slots &= slots - 1)
 		{
-			output_func(word);
-			no_found_words++;
+			next_cell = grid.Neighbor(cell, lowest_bit_index(slots));
+			if (used.Test(next_cell))
+			{
+				continue;
+			}
+
+			next_node = word_list.Step(node, grid.Cell(next_cell));
+			if (next_node == WL::NO_NODE)
+			{
+				continue; /* NOT_FOUND - no need to check further this prefix */
+			}
+
+			if (FILTERED && ((word_list.RequiredLetters(next_node) & ~grid_letters) != 0))
+			{
+				continue; /* every word with this prefix needs a letter that is not in the grid */
+			}
+
+			break;
+		}
+
+		if (slots == 0)
+		{
+			if (top == stack)
+			{
+				break; /* the cells of the given prefix stay used (the caller's) */
+			}
+
+			used.Reset(cell);
+			top--;
+			word_len--;
+			node = top->node;
+			cell = top->cell;
+			slots = top->slots;
+			continue;
 		}
+		slots &= slots - 1;
 
-		/* init x and y to i and j */
-		x = i;
-		y = j;
+		/* prepare the next word */
+		word[word_len] = grid.Cell(next_cell);
+		path[word_len] = (uint16_t)next_cell;
 
-		/* in a loop: 1) find next adjacent cell 2) recursive call to output_found_words_from_prefix */
-		while (get_next_adjacent_unused_cell(grid_ctrl, X, i, j, &x, &y))
+		used.Set(next_cell);
+		if ((parallel != NULL) &&
+			((word_len < parallel->split_depth) || ((word_len < MAX_SPLIT_DEPTH) && parallel->pool.IsStarving())))
 		{
-			/* prepare the next work */
-			word_len = strlen(word);
-			strcpy(word_next, word);
-			word_next[word_len] = grid[x][y];
-			word_next[word_len + 1] = '\0';
+			spawn_subtree(word, path, word_len + 1, next_node, next_cell);
+			used.Reset(next_cell);
+			continue;
+		}
 
-			/* prepare the next grid ctrl */
-			grid_copy(grid_ctrl_next, grid_ctrl, X);
-			grid_ctrl_next[x][y] = true; // cell used
+		top->node = node;
+		top->cell = cell;
+		top->slots = slots;
+		top++;
+		word_len++;
+		node = next_node;
+		cell = next_cell;
+		slots = FILTERED ? grid.NeighborSlots(cell, word_list.NextChars(node)) : ((1u << grid.NeighborCount(cell)) - 1);
+		if (word_list.IsWord(node))
+		{
+			output_found_word(word, path, word_len, node);
+		}
+	}
+}
 
-			output_found_words_from_prefix(word_next, x, y, grid_ctrl_next, X);
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: output_found_word                                                                                         *
+*                                                                                                                     *
+* DESCRIPTION: output (to output_sink) a word reached by the search if it was not found yet in this search            *
+*                                                                                                                     *
+* PARAMETERS: word, path, word_len, node - (in) as in output_found_words_from_prefix                                  *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: a word is output only the first time it is found (it may be found along many paths)                          *
+*        searching on a thread pool the word is collected by the task (see parallel_search) instead                   *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::output_found_word(char *word, const uint16_t *path, int word_len, typename WL::Node node)
+{
+	word[word_len] = '\0';
+	if (parallel == NULL)
+	{
+		if (word_epoch[word_list.WordId(node)] != epoch)
+		{
+			word_epoch[word_list.WordId(node)] = epoch;
+			if (output_paths)
+				output_sink->WordPath(word, word_len, path);
+			else
+				output_sink->Word(word, word_len);
+			no_found_words++;
 		}
 	}
-	/* else: NOT_FOUND - no need to check further this prefix */
+	else
+	{
+		/* merged (and deduplicated) when the task is done - see spawn_subtree */
+		thread_buffers().found.emplace_back(word_list.WordId(node),
+			typename parallel_search::found_word(word, output_paths ? std::vector<uint16_t>(path, path + word_len) : std::vector<uint16_t>()));
+	}
 }
 
 /***********************************************************************************************************************
 *                                                                                                                     *
-* FUNCTION: get_next_adjacent_unused_cell                                                                                 *
+* FUNCTION: thread_buffers                                                                                            *
+*                                                                                                                     *
+* DESCRIPTION: get the search buffers of the calling thread                                                           *
 *                                                                                                                     *
-* DESCRIPTION: get next adjecent unused cell                                                                          *
+* PARAMETERS: none                                                                                                    *
+*                                                                                                                     *
+* RETURN: search buffers (word, path, stack and used cells of a grid size, found words of the running task)          *
+*                                                                                                                     *
+* NOTES: a pool thread runs a task to its end before it takes another, so all tasks of a thread share its buffers     *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL, int X, int Y>
+typename WordsGrid<WL, X, Y>::task_buffers& WordsGrid<WL, X, Y>::thread_buffers()
+{
+	static thread_local task_buffers buffers;
+
+	return buffers;
+}
+
+/***********************************************************************************************************************
 *                                                                                                                     *
-* PARAMETERS: grid_ctrl - (in) grid control that marks which characters are used and which aren't e.g.:               *
-*                           (x = used; o = unused):                                                                   *
-*                           +-------+                                                                                 *
-*                           |x|x|x|x|                                                                                 *
-*                           +-------+                                                                                 *
-*                           |o|o|o|x|                                                                                 *
-*                           +-------+                                                                                 *
-*                           |o|o|o|o|                                                                                 *
-*                           +-------+                                                                                 *
-*                           |o|o|o|o|                                                                                 *
-*                           +-------+                                                                                 *
+* FUNCTION: spawn_subtree                                                                                             *
 *                                                                                                                     *
-*             i,j - (in) the x,y indices of the character to find the next adjacent unused cell from                  *
+* DESCRIPTION: search all found words from grid that start with a prefix on a pool task (see parallel_search)         *
 *                                                                                                                     *
-*             x,y - (out) the indices of next unused adjacent character                                               *
+* PARAMETERS: word, path, word_len, node, cell - (in) as in output_found_words_from_prefix (the prefix is copied to   *
+*             the task)                                                                                               *
 *                                                                                                                     *
-* RETURN: 0 - cell not found                                                                                          *
-*         1 - cell found                                                                                              *
+* RETURN: none                                                                                                        *
 *                                                                                                                     *
-* NOTES:                                                                                                              *
+* NOTES: must be called only during OutputFoundWords(pool)                                                            *
+*        a task copies only the prefix (O(word_len)): it is searched in the buffers of the pool thread, whose used    *
+*        cells are set from the prefix's path and reset after; the task's found words are merged under the lock once  *
 *                                                                                                                     *
 ***********************************************************************************************************************/
-template <int X, int Y>
-int WordsGrid<X, Y>::get_next_adjacent_unused_cell(bool grid_ctrl[][Y], int size, int i, int j, int *x, int *y)
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::spawn_subtree(const char *word, const uint16_t *path, int word_len, typename WL::Node node, int cell)
 {
-	while (((*x) != (i - 1)) || ((*y) != (j - 1)))
+	subtree task;
+
+	task.word.assign(word, word_len);
+	task.path.assign(path, path + word_len);
+	task.node = node;
+	task.cell = cell;
+
+	parallel->pool.Submit([this, task = std::move(task)]()
 	{
-		/*
-		check adjacent cell in the following order from X = the current cell.
-		(i,j) - current cell
-		(x,y) - current/next adjacent cell - initialised to (i,j)
-		-------------
-		| 8 | 1 | 2 |
-		-------------
-		| 7 | X | 3 |
-		-------------
-		| 6 | 5 | 4 |
-		-------------
-		*/
-		if (((*x) == i) && ((*y) == j))
-		{
-			/* current -> 1 */
-			(*x) = (i - 1);
-		}
-		else if (((*x) == (i - 1)) && ((*y) == j))
-		{
-			/* 1 -> 2 */
-			(*y) = (j + 1);
-		}
-		else if (((*x) == (i - 1)) && ((*y) == (j + 1)))
-		{
-			/* 2 -> 3 */
-			(*x) = i;
-		}
-		else if (((*x) == i) && ((*y) == (j + 1)))
-		{
-			/* 3 -> 4 */
-			(*x) = (i + 1);
-		}
-		else if (((*x) == (i + 1)) && ((*y) == (j + 1)))
-		{
-			/* 4 -> 5 */
-			(*y) = j;
-		}
-		else if (((*x) == (i + 1)) && ((*y) == j))
+		task_buffers& buffers = thread_buffers();
+		int word_len = (int)task.word.length(), i;
+
+		if (buffers.no_of_cells != grid.NoOfCells())
 		{
-			/* 5 -> 6 */
-			(*y) = (j - 1);
+			buffers.word.resize(grid.NoOfCells() + 1);
+			buffers.path.resize(grid.NoOfCells());
+			buffers.stack.resize(grid.NoOfCells());
+			buffers.used.Clear(grid.NoOfCells());
+			buffers.no_of_cells = grid.NoOfCells();
 		}
-		else if (((*x) == (i + 1)) && ((*y) == (j - 1)))
+
+		memcpy(buffers.word.data(), task.word.data(), word_len);
+		for (i = 0; i < word_len; i++)
 		{
-			/* 6 -> 7 */
-			(*x) = i;
+			buffers.path[i] = task.path[i];
+			buffers.used.Set(task.path[i]);
 		}
-		else /* (((*x) = i) && ((*y) = (j-1))) */
+		if (filtered)
+			output_found_words_from_prefix<true>(buffers.word.data(), buffers.path.data(), word_len, task.node, task.cell, buffers.used, buffers.stack.data());
+		else
+			output_found_words_from_prefix<false>(buffers.word.data(), buffers.path.data(), word_len, task.node, task.cell, buffers.used, buffers.stack.data());
+		for (i = 0; i < word_len; i++)
 		{
-			assert(((*x) == i) && ((*y) == (j - 1)));
-
-			/* 7 -> 8 */
-			(*x) = (i - 1);
+			buffers.used.Reset(task.path[i]);
 		}
 
-		if (((*x) >= 0) && ((*x) < size) && ((*y) >= 0) && ((*y) < Y) && (grid_ctrl[*x][*y] == false))
 		{
-			/* cell exists and unused */
-			return 1;
+			std::lock_guard<std::mutex> guard(parallel->lock);
+			for (std::pair<uint32_t, typename parallel_search::found_word>& found_word : buffers.found)
+			{
+				if (word_epoch[found_word.first] != epoch)
+				{
+					word_epoch[found_word.first] = epoch;
+					parallel->found.push_back(std::move(found_word.second));
+				}
+			}
 		}
+		buffers.found.clear();
+	});
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: new_epoch                                                                                                 *
+*                                                                                                                     *
+* DESCRIPTION: start a new search epoch - all words become "not found yet" without clearing word_epoch                *
+*                                                                                                                     *
+* PARAMETERS: none                                                                                                    *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: word_epoch is (re)allocated here if the word list was built after this words grid was constructed           *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::new_epoch()
+{
+	if (word_epoch.size() != word_list.GetNoOfWordIds())
+	{
+		word_epoch.assign(word_list.GetNoOfWordIds(), 0);
+		epoch = 0;
 	}
 
-	return 0;
+	epoch++;
+	if (epoch == 0)
+	{
+		/* wrapped around - stamps of 2^32 searches ago would look current */
+		std::fill(word_epoch.begin(), word_epoch.end(), 0);
+		epoch = 1;
+	}
 }
 
 /*******************************************************************************************************************************************************/
 /************************************************************ external functions definition ************************************************************/
 /*******************************************************************************************************************************************************/
 
-template <int X, int Y>
-WordsGrid<X, Y>::WordsGrid()
+template <class WL, int X, int Y>
+WordsGrid<WL, X, Y>::WordsGrid(const WL& _word_list, int x_len, int y_len) : word_list(_word_list), grid(x_len, y_len)
 {
-	init_grid(grid, X, '\0');
-	output_func = NULL;
+	word_buffer.resize(grid.NoOfCells() + 1);
+	path_buffer.resize(grid.NoOfCells());
+	stack_buffer.resize(grid.NoOfCells());
+	output_sink = NULL;
+	output_paths = false;
+	filtered = true;
+	parallel = NULL;
+	grid_letters = 0;
+	epoch = 0;
 	no_found_words = 0;
 }
 
-template <int X, int Y>
-WordsGrid<X, Y>::~WordsGrid()
+template <class WL, int X, int Y>
+WordsGrid<WL, X, Y>::~WordsGrid()
 {
 }
 
-template <int X, int Y>
-return_code WordsGrid<X, Y>::InitWordList(const char *file_name)
-{
-	return word_list.BuildWorldList(file_name);
-}
-
 /***********************************************************************************************************************
 *                                                                                                                     *
 * FUNCTION: WordsGrid_SetGrid                                                                                         *
 *                                                                                                                     *
-* DESCRIPTION: set grid from grid string length [X x Y] (convert to character 2D matrix)            *
+* DESCRIPTION: set grid from grid string length [X x Y] (kept row by row)                                            *
 *                                                                                                                     *
 * PARAMETERS: words_grid - (in/out) pointer to words grid to set its 2D character grid                                *
-*             string - (in) string (length X x Y) e.g. (3 x 4): "abcdefghijkl"                      *
+*             string - (in) string (length X x Y, the grid size given to the constructor) e.g. (3 x 4): "abcdefghijkl" *
 *                                                                                                                     *
 * RETURN: none                                                                                                        *
 *                                                                                                                     *
 * NOTES:                                                                                                              *
 *                                                                                                                     *
 ***********************************************************************************************************************/
-template <int X, int Y>
-void WordsGrid<X, Y>::SetGrid(const char *string)
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::SetGrid(const char *string)
 {
-	int i, j, k = 0;
+	int cell;
+
+	assert(strlen(string) == (size_t)grid.NoOfCells());
 
-	assert(strlen(string) == (X*Y));
+	grid.SetCells(string);
 
-	for (i = 0; i < X; i++)
+	grid_letters = 0;
+	for (cell = 0; cell < grid.NoOfCells(); cell++)
 	{
-		for (j = 0; j < Y; j++)
-		{
-			grid[i][j] = string[k++];
-		}
+		grid_letters |= letter_bit(grid.Cell(cell));
 	}
 }
 
 /***********************************************************************************************************************
 *                                                                                                                     *
-* FUNCTION: WordsGrid_SetOutputFunc                                                                                   *
+* FUNCTION: WordsGrid_SetOutputSink                                                                                   *
 *                                                                                                                     *
-* DESCRIPTION: set output function in words grid                                                                      *
+* DESCRIPTION: set the result sink of words grid                                                                      *
 *                                                                                                                     *
-* PARAMETERS: words_grid - (in/out) pointer to words grid to set its output_func                                      *
-*             output_func - (in) pointer to output function                                                           *
+* PARAMETERS: words_grid - (in/out) pointer to words grid to set its output_sink                                      *
+*             sink - (in) result sink (owned by the caller - must live until the last OutputFoundWords returns)      *
 *                                                                                                                     *
 * RETURN: none                                                                                                        *
 *                                                                                                                     *
 * NOTES:                                                                                                              *
 *                                                                                                                     *
 ***********************************************************************************************************************/
-template <int X, int Y>
-void WordsGrid<X, Y>::SetOutputFunc(void(*out_func) (const char *word))
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::SetOutputSink(WordSink *sink)
 {
-	output_func = out_func;
+	output_sink = sink;
+	output_paths = (sink != NULL) && sink->WantsPaths();
 }
 
 /***********************************************************************************************************************
 *                                                                                                                     *
 * FUNCTION: WordsGrid_OutputFoundWords                                                                                *
 *                                                                                                                     *
-* DESCRIPTION: output (using output function) found words from word list in grid                                      *
+* DESCRIPTION: output (to output sink) found words from word list in grid                                             *
 *                                                                                                                     *
 * PARAMETERS: words_grid - (in/out) pointer to words grid                                                             *
 *                                                                                                                     *
 * RETURN: none                                                                                                        *
 *                                                                                                                     *
-* NOTES: must be called only after SetGrid and SetOutputFunc                   *
+* NOTES: must be called only after SetGrid and SetOutputSink                                                          *
+*        every found word is output once (the first time it is found)                                                 *
 *                                                                                                                     *
 ***********************************************************************************************************************/
-template <int X, int Y>
-void WordsGrid<X, Y>::OutputFoundWords()
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::OutputFoundWords()
 {
-	bool grid_ctrl[X][Y];
-	char word[(X*Y) + 1];
-	int i, j;
+	CellSet<X * Y> used;
+	char *word = word_buffer.data();
+	uint16_t *path = path_buffer.data();
+	typename WL::Node node;
+	int cell;
 
+	used.Clear(grid.NoOfCells());
+	new_epoch();
 	no_found_words = 0;
-	for (i = 0; i < X; i++)
+	for (cell = 0; cell < grid.NoOfCells(); cell++)
 	{
-		for (j = 0; j < Y; j++)
+		node = word_list.Step(word_list.Root(), grid.Cell(cell));
+		if (node == WL::NO_NODE)
 		{
-			init_grid(grid_ctrl, X, false);
-			grid_ctrl[i][j] = true; // cell used
+			continue;
+		}
+
+		word[0] = grid.Cell(cell);
+		path[0] = (uint16_t)cell;
 
-			word[0] = grid[i][j];
-			word[1] = '\0';
+		used.Set(cell); // cell used
+		if (filtered)
+			output_found_words_from_prefix<true>(word, path, 1, node, cell, used, stack_buffer.data());
+		else
+			output_found_words_from_prefix<false>(word, path, 1, node, cell, used, stack_buffer.data());
+		used.Reset(cell);
+	}
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: WordsGrid_OutputFoundWords                                                                                *
+*                                                                                                                     *
+* DESCRIPTION: output (to output sink) found words from word list in grid - searched on a thread pool                 *
+*                                                                                                                     *
+* PARAMETERS: pool - (in) thread pool to search on                                                                    *
+*             split_depth - (in) prefixes shorter than this are searched as separate pool tasks (1 - one task per     *
+*                           start cell; 2 - and one per start cell's adjacent cell; ...) - longer prefixes (up to     *
+*                           MAX_SPLIT_DEPTH) are split off to tasks only while a pool thread is idle w/ none queued   *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: must be called only after SetGrid and SetOutputSink                                                          *
+*        every found word is output once (in sorted order) after the search is done                                  *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL, int X, int Y>
+void WordsGrid<WL, X, Y>::OutputFoundWords(ThreadPool& pool, int split_depth)
+{
+	parallel_search search(pool, split_depth);
+	char word[2];
+	uint16_t path[1];
+	typename WL::Node node;
+	int cell;
 
-			output_found_words_from_prefix(word, i, j, grid_ctrl, X);
+	new_epoch();
+	parallel = &search;
+	for (cell = 0; cell < grid.NoOfCells(); cell++)
+	{
+		node = word_list.Step(word_list.Root(), grid.Cell(cell));
+		if (node == WL::NO_NODE)
+		{
+			continue;
 		}
+
+		word[0] = grid.Cell(cell);
+		path[0] = (uint16_t)cell;
+
+		spawn_subtree(word, path, 1, node, cell);
+	}
+	pool.Wait();
+	parallel = NULL;
+
+	std::sort(search.found.begin(), search.found.end());
+
+	for (const typename parallel_search::found_word& found_word : search.found)
+	{
+		if (output_paths)
+			output_sink->WordPath(found_word.first.c_str(), found_word.first.length(), found_word.second.data());
+		else
+			output_sink->Word(found_word.first.c_str(), found_word.first.length());
+	}
+	no_found_words = (int)search.found.size();
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: GridLayout<GRID_ANY_SIZE, GRID_ANY_SIZE> (constructor)                                                    *
+*                                                                                                                     *
+* DESCRIPTION: build the adjacent cells tables of an x_len x y_len grid (as GridNeighbors does at compile time)       *
+*                                                                                                                     *
+* PARAMETERS: x_len - (in) number of rows                                                                             *
+*             y_len - (in) number of columns                                                                          *
+*                                                                                                                     *
+* RETURN: none                                                                                                        *
+*                                                                                                                     *
+* NOTES: x_len x y_len must be 1..MAX_CELLS                                                                           *
+*                                                                                                                     *
+***********************************************************************************************************************/
+GridLayout<GRID_ANY_SIZE, GRID_ANY_SIZE>::GridLayout(int _x_len, int _y_len) : x_len(_x_len), y_len(_y_len)
+{
+	const int di[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+	const int dj[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	int i, j, k, x, y;
+
+	assert((x_len > 0) && (y_len > 0) && ((x_len * y_len) <= MAX_CELLS));
+
+	cells.assign(x_len * y_len, '\0');
+	count.assign(x_len * y_len, 0);
+	neighbors.assign(x_len * y_len * 8, 0);
+	neighbor_chars.assign(x_len * y_len, 0);
+	char_slots.assign(x_len * y_len * NO_OF_CHAR_BITS, 0);
+	for (i = 0; i < x_len; i++)
+	{
+		for (j = 0; j < y_len; j++)
+		{
+			for (k = 0; k < 8; k++)
+			{
+				x = i + di[k];
+				y = j + dj[k];
+				if ((x >= 0) && (x < x_len) && (y >= 0) && (y < y_len))
+				{
+					neighbors[(((i * y_len) + j) * 8) + count[(i * y_len) + j]++] = (uint16_t)((x * y_len) + y);
+				}
+			}
+		}
+	}
+}
+
+void GridLayout<GRID_ANY_SIZE, GRID_ANY_SIZE>::SetCells(const char *string)
+{
+	uint32_t bit;
+	int cell, k;
+
+	memcpy(cells.data(), string, cells.size());
+	std::fill(char_slots.begin(), char_slots.end(), 0);
+	for (cell = 0; cell < NoOfCells(); cell++)
+	{
+		neighbor_chars[cell] = 0;
+		for (k = 0; k < count[cell]; k++)
+		{
+			bit = char_bit(cells[neighbors[(cell * 8) + k]]);
+			neighbor_chars[cell] |= bit;
+			char_slots[(cell * NO_OF_CHAR_BITS) + lowest_bit_index(bit)] |= (uint8_t)(1u << k);
+		}
+	}
+}
+
+template <class WL>
+WordsGridAnySize<WL>::WordsGridAnySize(const WL& _word_list) : word_list(_word_list), grid_4x4(_word_list), grid_5x5(_word_list), grid_6x6(_word_list)
+{
+	grid_size = NO_GRID;
+	output_sink = NULL;
+	filtered = true;
+}
+
+template <class WL>
+WordsGridAnySize<WL>::~WordsGridAnySize()
+{
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: ParseGrid                                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: get the grid size and characters of a grid string                                                      *
+*                                                                                                                     *
+* PARAMETERS: string - (in) square grid as one string, e.g. (4 x 4): "abcdefghijklmnop"                               *
+*                      or rows separated by '/', e.g. (2 x 3): "abc/def", (1 x 4): "abcd/"                            *
+*             x_len - (out) number of rows                                                                            *
+*             y_len - (out) number of columns                                                                         *
+*             cells - (out) grid characters row by row (may be NULL)                                                  *
+*                                                                                                                     *
+* RETURN: RC_NO_ERROR or RC_INVALID_GRID (empty, not square w/o '/', rows of different lengths or too many cells)    *
+*                                                                                                                     *
+* NOTES:                                                                                                              *
+*                                                                                                                     *
+***********************************************************************************************************************/
+return_code ParseGrid(const char *string, int *x_len, int *y_len, std::string *cells)
+{
+	size_t length = strlen(string), rows = 0, columns = 0, row_length = 0, i;
+
+	if (strchr(string, '/') == NULL)
+	{
+		/* square grid */
+		while ((columns * columns) < length)
+		{
+			columns++;
+		}
+		if ((length == 0) || ((columns * columns) != length))
+		{
+			return RC_INVALID_GRID;
+		}
+		rows = columns;
+	}
+	else
+	{
+		for (i = 0; i <= length; i++)
+		{
+			if ((string[i] != '/') && (string[i] != '\0'))
+			{
+				row_length++;
+				continue;
+			}
+
+			if ((string[i] == '\0') && (row_length == 0) && (rows > 0))
+			{
+				break; /* '/' after the last row */
+			}
+			if ((row_length == 0) || ((rows > 0) && (row_length != columns)))
+			{
+				return RC_INVALID_GRID;
+			}
+			columns = row_length;
+			row_length = 0;
+			rows++;
+		}
+	}
+
+	if ((rows * columns) > GridLayout<GRID_ANY_SIZE, GRID_ANY_SIZE>::MAX_CELLS)
+	{
+		return RC_INVALID_GRID;
+	}
+
+	*x_len = (int)rows;
+	*y_len = (int)columns;
+	if (cells != NULL)
+	{
+		cells->clear();
+		for (i = 0; i < length; i++)
+		{
+			if (string[i] != '/')
+			{
+				cells->push_back(string[i]);
+			}
+		}
+	}
+
+	return RC_NO_ERROR;
+}
+
+/***********************************************************************************************************************
+*                                                                                                                     *
+* FUNCTION: WordsGridAnySize_SetGrid                                                                                  *
+*                                                                                                                     *
+* DESCRIPTION: set grid from grid string (see ParseGrid) and select the words grid of its size                        *
+*                                                                                                                     *
+* PARAMETERS: string - (in) grid string                                                                               *
+*                                                                                                                     *
+* RETURN: RC_NO_ERROR or RC_INVALID_GRID (no grid is set)                                                             *
+*                                                                                                                     *
+* NOTES: the words grid of a size w/o an instantiation is (re)built only when the grid size changes                  *
+*                                                                                                                     *
+***********************************************************************************************************************/
+template <class WL>
+return_code WordsGridAnySize<WL>::SetGrid(const char *string)
+{
+	std::string cells;
+	int x_len, y_len;
+
+	grid_size = NO_GRID;
+	if (ParseGrid(string, &x_len, &y_len, &cells) != RC_NO_ERROR)
+	{
+		return RC_INVALID_GRID;
+	}
+
+	if ((x_len == 4) && (y_len == 4))
+	{
+		grid_4x4.SetGrid(cells.c_str());
+		grid_size = GRID_4X4;
+	}
+	else if ((x_len == 5) && (y_len == 5))
+	{
+		grid_5x5.SetGrid(cells.c_str());
+		grid_size = GRID_5X5;
+	}
+	else if ((x_len == 6) && (y_len == 6))
+	{
+		grid_6x6.SetGrid(cells.c_str());
+		grid_size = GRID_6X6;
+	}
+	else
+	{
+		if ((grid_any_size == NULL) || (grid_any_size->GetXLen() != x_len) || (grid_any_size->GetYLen() != y_len))
+		{
+			grid_any_size.reset(new WordsGrid<WL, GRID_ANY_SIZE, GRID_ANY_SIZE>(word_list, x_len, y_len));
+			grid_any_size->SetOutputSink(output_sink);
+			grid_any_size->SetFiltered(filtered);
+		}
+		grid_any_size->SetGrid(cells.c_str());
+		grid_size = GRID_OTHER;
+	}
+
+	return RC_NO_ERROR;
+}
+
+template <class WL>
+void WordsGridAnySize<WL>::SetOutputSink(WordSink *sink)
+{
+	output_sink = sink;
+	grid_4x4.SetOutputSink(sink);
+	grid_5x5.SetOutputSink(sink);
+	grid_6x6.SetOutputSink(sink);
+	if (grid_any_size != NULL)
+	{
+		grid_any_size->SetOutputSink(sink);
+	}
+}
+
+template <class WL>
+void WordsGridAnySize<WL>::SetFiltered(bool on)
+{
+	filtered = on;
+	grid_4x4.SetFiltered(on);
+	grid_5x5.SetFiltered(on);
+	grid_6x6.SetFiltered(on);
+	if (grid_any_size != NULL)
+	{
+		grid_any_size->SetFiltered(on);
+	}
+}
+
+template <class WL>
+void WordsGridAnySize<WL>::OutputFoundWords()
+{
+	switch (grid_size)
+	{
+	case GRID_4X4: grid_4x4.OutputFoundWords(); break;
+	case GRID_5X5: grid_5x5.OutputFoundWords(); break;
+	case GRID_6X6: grid_6x6.OutputFoundWords(); break;
+	case GRID_OTHER: grid_any_size->OutputFoundWords(); break;
+	default: assert(false); break;
+	}
+}
+
+template <class WL>
+void WordsGridAnySize<WL>::OutputFoundWords(ThreadPool& pool, int split_depth)
+{
+	switch (grid_size)
+	{
+	case GRID_4X4: grid_4x4.OutputFoundWords(pool, split_depth); break;
+	case GRID_5X5: grid_5x5.OutputFoundWords(pool, split_depth); break;
+	case GRID_6X6: grid_6x6.OutputFoundWords(pool, split_depth); break;
+	case GRID_OTHER: grid_any_size->OutputFoundWords(pool, split_depth); break;
+	default: assert(false); break;
+	}
+}
+
+template <class WL>
+int WordsGridAnySize<WL>::GetNoFoundWords()
+{
+	switch (grid_size)
+	{
+	case GRID_4X4: return grid_4x4.GetNoFoundWords();
+	case GRID_5X5: return grid_5x5.GetNoFoundWords();
+	case GRID_6X6: return grid_6x6.GetNoFoundWords();
+	case GRID_OTHER: return grid_any_size->GetNoFoundWords();
+	default: return 0;
+	}
+}
+
+template <class WL>
+int WordsGridAnySize<WL>::GetXLen() const
+{
+	switch (grid_size)
+	{
+	case GRID_4X4: return 4;
+	case GRID_5X5: return 5;
+	case GRID_6X6: return 6;
+	case GRID_OTHER: return grid_any_size->GetXLen();
+	default: return 0;
+	}
+}
+
+template <class WL>
+int WordsGridAnySize<WL>::GetYLen() const
+{
+	switch (grid_size)
+	{
+	case GRID_4X4: return 4;
+	case GRID_5X5: return 5;
+	case GRID_6X6: return 6;
+	case GRID_OTHER: return grid_any_size->GetYLen();
+	default: return 0;
 	}
 }
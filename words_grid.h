@@ -1,48 +1,300 @@
 #ifndef _WORDS_GRID_H_
 #define _WORDS_GRID_H_
 
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 #include "word_list.h"
+#include "word_sink.h"
 
-// comment in/out one of the following namespaces to compile WordList class from WordListTree or from WordListSet
-using namespace WordListSet;
-//using namespace WordListTree;
+class ThreadPool;
 
-/* words grid struct */
+/* grid size known at run time only: WordsGrid<GRID_ANY_SIZE, GRID_ANY_SIZE> */
+const int GRID_ANY_SIZE = 0;
+
+/* character sets of char_bit: bits 0..25 - 'a'..'z', bit 26 - any other character */
+const int NO_OF_CHAR_BITS = 27;
+
+/* index of the lowest set bit (bits != 0) */
+inline int lowest_bit_index(uint32_t bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+/* set of grid cells (cell index = i * Y + j) as a bitmask of N bits */
+template <int N>
+struct CellSet
+{
+	uint64_t bits[(N + 63) / 64];
+
+	void Clear(int) { memset(bits, 0, sizeof(bits)); }
+	bool Test(int cell) const { return ((bits[cell >> 6] >> (cell & 63)) & 1) != 0; }
+	void Set(int cell) { bits[cell >> 6] |= (uint64_t)1 << (cell & 63); }
+	void Reset(int cell) { bits[cell >> 6] &= ~((uint64_t)1 << (cell & 63)); }
+};
+
+/* set of grid cells of a grid of any size */
+template <>
+struct CellSet<GRID_ANY_SIZE>
+{
+	std::vector<uint64_t> bits;
+
+	void Clear(int no_of_cells) { bits.assign((no_of_cells + 63) / 64, 0); }
+	bool Test(int cell) const { return ((bits[cell >> 6] >> (cell & 63)) & 1) != 0; }
+	void Set(int cell) { bits[cell >> 6] |= (uint64_t)1 << (cell & 63); }
+	void Reset(int cell) { bits[cell >> 6] &= ~((uint64_t)1 << (cell & 63)); }
+};
+
+/* adjacent cells of every cell of an X x Y grid - generated at compile time for every grid size                   *
+ * in the following order from X = the current cell (cells outside the grid are left out):                          *
+ * -------------                                                                                                    *
+ * | 8 | 1 | 2 |                                                                                                    *
+ * -------------                                                                                                    *
+ * | 7 | X | 3 |                                                                                                    *
+ * -------------                                                                                                    *
+ * | 6 | 5 | 4 |                                                                                                    *
+ * -------------                                                                                                    */
 template <int X, int Y>
+struct GridNeighbors
+{
+	uint8_t count[X * Y];
+	uint16_t cell[X * Y][8];
+
+	constexpr GridNeighbors() : count(), cell()
+	{
+		const int di[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+		const int dj[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+		for (int i = 0; i < X; i++)
+		{
+			for (int j = 0; j < Y; j++)
+			{
+				for (int k = 0; k < 8; k++)
+				{
+					int x = i + di[k], y = j + dj[k];
+					if ((x >= 0) && (x < X) && (y >= 0) && (y < Y))
+					{
+						cell[(i * Y) + j][count[(i * Y) + j]++] = (uint16_t)((x * Y) + y);
+					}
+				}
+			}
+		}
+	}
+};
+
+/* characters and adjacent cells of an X x Y grid (row by row: cell (i,j) is i * Y + j) */
+template <int X, int Y>
+class GridLayout
+{
+private:
+	char cells[X * Y];
+	uint32_t neighbor_chars[X * Y]; /* per cell: the characters of its adjacent cells (see char_bit) */
+	uint8_t char_slots[X * Y][NO_OF_CHAR_BITS]; /* per cell and character bit: its adjacent cells of that character */
+
+	static constexpr GridNeighbors<X, Y> neighbors = GridNeighbors<X, Y>();
+
+public:
+
+	GridLayout([[maybe_unused]] int x_len, [[maybe_unused]] int y_len)
+	{
+		assert((x_len == X) && (y_len == Y));
+		memset(cells, '\0', sizeof(cells));
+		memset(neighbor_chars, 0, sizeof(neighbor_chars));
+		memset(char_slots, 0, sizeof(char_slots));
+	}
+	int XLen() const { return X; }
+	int YLen() const { return Y; }
+	int NoOfCells() const { return X * Y; }
+	char Cell(int cell) const { return cells[cell]; }
+	void SetCells(const char *string)
+	{
+		memcpy(cells, string, X * Y);
+		memset(char_slots, 0, sizeof(char_slots));
+		for (int cell = 0; cell < X * Y; cell++)
+		{
+			neighbor_chars[cell] = 0;
+			for (int k = 0; k < neighbors.count[cell]; k++)
+			{
+				uint32_t bit = char_bit(cells[neighbors.cell[cell][k]]);
+				neighbor_chars[cell] |= bit;
+				char_slots[cell][lowest_bit_index(bit)] |= (uint8_t)(1u << k);
+			}
+		}
+	}
+	int NeighborCount(int cell) const { return neighbors.count[cell]; }
+	int Neighbor(int cell, int k) const { return neighbors.cell[cell][k]; }
+	uint32_t NeighborChars(int cell) const { return neighbor_chars[cell]; }
+
+	/* the adjacent cells (bit k - Neighbor(cell, k)) whose character is one of chars (see char_bit) */
+	uint32_t NeighborSlots(int cell, uint32_t chars) const
+	{
+		uint32_t slots = 0;
+
+		for (chars &= neighbor_chars[cell]; chars != 0; chars &= chars - 1)
+			slots |= char_slots[cell][lowest_bit_index(chars)];
+		return slots;
+	}
+};
+
+/* characters and adjacent cells of a grid of any size (the adjacent cells tables are built at run time) */
+template <>
+class GridLayout<GRID_ANY_SIZE, GRID_ANY_SIZE>
+{
+private:
+	int x_len, y_len;
+	std::vector<char> cells;
+	std::vector<uint8_t> count;
+	std::vector<uint16_t> neighbors; /* 8 entries per cell */
+	std::vector<uint32_t> neighbor_chars;
+	std::vector<uint8_t> char_slots; /* NO_OF_CHAR_BITS entries per cell */
+
+public:
+
+	/* largest grid: cell indices are 16 bit */
+	enum { MAX_CELLS = 65536 };
+
+	GridLayout(int x_len, int y_len);
+	int XLen() const { return x_len; }
+	int YLen() const { return y_len; }
+	int NoOfCells() const { return x_len * y_len; }
+	char Cell(int cell) const { return cells[cell]; }
+	void SetCells(const char *string);
+	int NeighborCount(int cell) const { return count[cell]; }
+	int Neighbor(int cell, int k) const { return neighbors[(cell * 8) + k]; }
+	uint32_t NeighborChars(int cell) const { return neighbor_chars[cell]; }
+	uint32_t NeighborSlots(int cell, uint32_t chars) const
+	{
+		uint32_t slots = 0;
+
+		for (chars &= neighbor_chars[cell]; chars != 0; chars &= chars - 1)
+			slots |= char_slots[(cell * NO_OF_CHAR_BITS) + lowest_bit_index(chars)];
+		return slots;
+	}
+};
+
+/* words grid struct (X x Y grid; WordsGrid<WL, GRID_ANY_SIZE, GRID_ANY_SIZE> - grid size given to the constructor) *
+ * WL - the word list class of any backend (WordListTree, WordListSet, WordListArray or WordListDawg ::WordList):      *
+ *      the search uses its cursor API (Root, Step, IsWord, WordId, RequiredLetters, NextChars) and GetNoOfWordIds    */
+template <class WL, int X, int Y>
 class WordsGrid
 {
 private:
-	/* word list to search words from */
-	WordList word_list;
-	
+	/* word list to search words from (read only - may be shared by many words grids, e.g. on many threads) */
+	const WL& word_list;
+
 	/* characters grid */
-	char grid[X][Y];
+	GridLayout<X, Y> grid;
+
+	/* letter set of the grid's characters (see letter_bit) - a prefix whose words all need another letter is skipped */
+	uint32_t grid_letters;
+
+	/* search stack frame: the last cell of a prefix, the word list cursor at the prefix and the adjacent cells still to  *
+	 * try (bit k - Neighbor(cell, k))                                                                                  */
+	struct search_frame
+	{
+		typename WL::Node node;
+		int cell;
+		uint32_t slots;
+	};
+
+	/* found word buffer, its cells and the search stack (for the search on the calling thread) - one entry per grid cell */
+	std::vector<char> word_buffer;
+	std::vector<uint16_t> path_buffer;
+	std::vector<search_frame> stack_buffer;
 
 	// number of found words
 	int no_found_words;
-	
-	/* output function to be used for all found words in grid */
-	void (*output_func) (const char *word);
 
-	template <class type>
-	void init_grid (type grid[][Y], int x_len, type init_val);
+	/* found words dedup: word_epoch[word id] is the search epoch in which the word was last found */
+	std::vector<uint32_t> word_epoch;
+	uint32_t epoch;
+	void new_epoch();
 
-	template <class type>
-	void grid_copy (type grid_dest[][Y], type grid_src[][Y], int size);
+	/* result sink of all found words in grid (and whether it takes each word's path - see WordSink::WantsPaths) */
+	WordSink *output_sink;
+	bool output_paths;
 
-	void output_found_words_from_prefix (char *word, int i, int j, bool grid_ctrl[][Y], int size);
+	/* search filters on (see SetFiltered) */
+	bool filtered;
 
-	int get_next_adjacent_unused_cell (bool grid_ctrl[][Y], int size, int i, int j, int *x, int *y);
+	/* search on a thread pool: found words are collected here - NULL when searching on the calling thread only */
+	struct parallel_search;
+	parallel_search *parallel;
+
+	/* prefix to be searched by a pool task and the search buffers of a pool thread (reused by all its tasks) */
+	struct subtree;
+	struct task_buffers;
+	static task_buffers& thread_buffers();
+	void spawn_subtree (const char *word, const uint16_t *path, int word_len, typename WL::Node node, int cell);
+
+	template <bool FILTERED>
+	void output_found_words_from_prefix (char *word, uint16_t *path, int word_len, typename WL::Node node, int cell, CellSet<X * Y>& used, search_frame *stack);
+	void output_found_word (char *word, const uint16_t *path, int word_len, typename WL::Node node);
 
 public:
 
-	WordsGrid();
+	explicit WordsGrid(const WL& word_list, int x_len = X, int y_len = Y);
 	~WordsGrid();
-	return_code InitWordList(const char *file_name);
 	void SetGrid(const char *string);
-	void SetOutputFunc(void (*out_func) (const char *word));
+	void SetOutputSink(WordSink *sink);
 	void OutputFoundWords();
+	void OutputFoundWords(ThreadPool& pool, int split_depth = 2);
 	int GetNoFoundWords() { return no_found_words; }
+
+	/* search filters (default: on) - off, every adjacent cell is stepped to and no prefix is skipped for its required   *
+	 * letters: the plain search that finds the same words (the reference the filters are tested against)             */
+	void SetFiltered(bool on) { filtered = on; }
+
+	/* longest prefix split off to a pool task while a pool thread is idle (see OutputFoundWords(pool)) */
+	enum { MAX_SPLIT_DEPTH = 8 };
+	int GetXLen() const { return grid.XLen(); }
+	int GetYLen() const { return grid.YLen(); }
+};
+
+/* get the grid size (and characters) of a grid string: square grid as one string or rows separated by '/' */
+return_code ParseGrid(const char *string, int *x_len, int *y_len, std::string *cells);
+
+/* words grid of the size of the grid set - common sizes are searched by WordsGrid<WL, 4,4>, <WL, 5,5> and <WL, 6,6>    *
+ * (compile time adjacent cells tables), any other size by WordsGrid<WL, GRID_ANY_SIZE, GRID_ANY_SIZE>                 */
+template <class WL>
+class WordsGridAnySize
+{
+private:
+	const WL& word_list;
+
+	WordsGrid<WL, 4,4> grid_4x4;
+	WordsGrid<WL, 5,5> grid_5x5;
+	WordsGrid<WL, 6,6> grid_6x6;
+	std::unique_ptr<WordsGrid<WL, GRID_ANY_SIZE, GRID_ANY_SIZE> > grid_any_size;
+
+	/* the words grid of the grid set */
+	enum { NO_GRID, GRID_4X4, GRID_5X5, GRID_6X6, GRID_OTHER } grid_size;
+
+	/* result sink of all found words in grid and the search filters on (see WordsGrid::SetFiltered) */
+	WordSink *output_sink;
+	bool filtered;
+
+public:
+
+	explicit WordsGridAnySize(const WL& word_list);
+	~WordsGridAnySize();
+
+	return_code SetGrid(const char *string);
+	void SetOutputSink(WordSink *sink);
+	void SetFiltered(bool on);
+	void OutputFoundWords();
+	void OutputFoundWords(ThreadPool& pool, int split_depth = 2);
+	int GetNoFoundWords();
+	int GetXLen() const;
+	int GetYLen() const;
 };
 
 #endif // _WORDS_GRID_H_